@@ -42,6 +42,12 @@
  * in the hope that the final linked shader will be found in the cache.
  * If anything goes wrong (shader variant not found, backend cache item is
  * corrupt, etc) we will use a fallback path to compile and link the IR.
+ *
+ * Programs that get relinked with the same set of shaders and link state
+ * are common (e.g. material systems calling glLinkProgram repeatedly), so
+ * the metadata of recently written or read programs is also kept in a small
+ * in-memory cache in front of the disk cache.  A hit there skips both the
+ * disk access and the asynchronous write latency of disk_cache_put().
  */
 
 #include "compiler/shader_info.h"
@@ -57,7 +63,10 @@
 #include "program.h"
 #include "serialize.h"
 #include "shader_cache.h"
+#include "util/hash_table.h"
+#include "util/list.h"
 #include "util/mesa-sha1.h"
+#include "util/simple_mtx.h"
 #include "string_to_uint_map.h"
 #include "main/mtypes.h"
 
@@ -67,6 +76,139 @@ extern "C" {
 #include "program/program.h"
 }
 
+/* Upper bound on the memory used by the in-memory program metadata cache.
+ * Least recently used entries are evicted once it is exceeded.
+ */
+#define MEMORY_CACHE_MAX_SIZE (16 * 1024 * 1024)
+
+struct memory_cache_item {
+   struct list_head link;
+   cache_key key;
+   size_t size;
+   uint8_t *data;
+};
+
+/* The program sha1 is computed with disk_cache_compute_key(), which mixes in
+ * the driver identity of the disk cache, so one process-wide table can be
+ * shared by every context and screen.
+ */
+static struct {
+   simple_mtx_t lock;
+   struct hash_table *items;
+   struct list_head lru;
+   size_t total_size;
+} memory_cache = { _SIMPLE_MTX_INITIALIZER_NP, NULL, { NULL, NULL }, 0 };
+
+static uint32_t
+memory_cache_key_hash(const void *key)
+{
+   return _mesa_hash_data(key, sizeof(cache_key));
+}
+
+static bool
+memory_cache_key_equal(const void *a, const void *b)
+{
+   return memcmp(a, b, sizeof(cache_key)) == 0;
+}
+
+static void
+memory_cache_remove_locked(struct memory_cache_item *item)
+{
+   _mesa_hash_table_remove_key(memory_cache.items, item->key);
+   list_del(&item->link);
+   memory_cache.total_size -= item->size;
+   free(item->data);
+   free(item);
+}
+
+static void
+memory_cache_put(const cache_key key, const void *data, size_t size)
+{
+   if (size > MEMORY_CACHE_MAX_SIZE / 4)
+      return;
+
+   struct memory_cache_item *item =
+      (struct memory_cache_item *) malloc(sizeof(*item));
+   if (!item)
+      return;
+
+   item->data = (uint8_t *) malloc(size);
+   if (!item->data) {
+      free(item);
+      return;
+   }
+
+   memcpy(item->key, key, sizeof(cache_key));
+   memcpy(item->data, data, size);
+   item->size = size;
+
+   simple_mtx_lock(&memory_cache.lock);
+
+   if (!memory_cache.items) {
+      memory_cache.items = _mesa_hash_table_create(NULL, memory_cache_key_hash,
+                                                   memory_cache_key_equal);
+      list_inithead(&memory_cache.lru);
+   }
+
+   struct hash_entry *entry =
+      _mesa_hash_table_search(memory_cache.items, key);
+   if (entry)
+      memory_cache_remove_locked((struct memory_cache_item *) entry->data);
+
+   while (memory_cache.total_size + size > MEMORY_CACHE_MAX_SIZE &&
+          !list_is_empty(&memory_cache.lru)) {
+      memory_cache_remove_locked(
+         list_last_entry(&memory_cache.lru, struct memory_cache_item, link));
+   }
+
+   _mesa_hash_table_insert(memory_cache.items, item->key, item);
+   list_add(&item->link, &memory_cache.lru);
+   memory_cache.total_size += size;
+
+   simple_mtx_unlock(&memory_cache.lock);
+}
+
+/* Returns a malloc'ed copy of the cached metadata, or NULL on a miss. */
+static uint8_t *
+memory_cache_get(const cache_key key, size_t *size)
+{
+   uint8_t *data = NULL;
+
+   simple_mtx_lock(&memory_cache.lock);
+
+   struct hash_entry *entry = memory_cache.items ?
+      _mesa_hash_table_search(memory_cache.items, key) : NULL;
+   if (entry) {
+      struct memory_cache_item *item = (struct memory_cache_item *) entry->data;
+
+      data = (uint8_t *) malloc(item->size);
+      if (data) {
+         memcpy(data, item->data, item->size);
+         *size = item->size;
+
+         list_del(&item->link);
+         list_add(&item->link, &memory_cache.lru);
+      }
+   }
+
+   simple_mtx_unlock(&memory_cache.lock);
+
+   return data;
+}
+
+static void
+memory_cache_remove(const cache_key key)
+{
+   simple_mtx_lock(&memory_cache.lock);
+
+   struct hash_entry *entry = memory_cache.items ?
+      _mesa_hash_table_search(memory_cache.items, key) : NULL;
+   if (entry)
+      memory_cache_remove_locked((struct memory_cache_item *) entry->data);
+
+   simple_mtx_unlock(&memory_cache.lock);
+}
+
 static void
 compile_shaders(struct gl_context *ctx, struct gl_shader_program *prog) {
    for (unsigned i = 0; i < prog->NumShaders; i++) {
@@ -128,6 +270,7 @@ shader_cache_write_program_metadata(struct gl_context *ctx,
 
    disk_cache_put(cache, prog->data->sha1, metadata.data, metadata.size,
                   &cache_item_metadata);
+   memory_cache_put(prog->data->sha1, metadata.data, metadata.size);
 
    char sha1_buf[41];
    if (ctx->_Shader->Flags & GLSL_CACHE_INFO) {
@@ -210,8 +353,13 @@ shader_cache_read_program_metadata(struct gl_context *ctx,
    ralloc_free(buf);
 
    size_t size;
-   uint8_t *buffer = (uint8_t *) disk_cache_get(cache, prog->data->sha1,
-                                                &size);
+   bool from_memory = true;
+   uint8_t *buffer = memory_cache_get(prog->data->sha1, &size);
+   if (buffer == NULL) {
+      from_memory = false;
+      buffer = (uint8_t *) disk_cache_get(cache, prog->data->sha1, &size);
+   }
+
    if (buffer == NULL) {
       /* Cached program not found. We may have seen the individual shaders
        * before and skipped compiling but they may not have been used together
@@ -229,8 +377,8 @@ shader_cache_read_program_metadata(struct gl_context *ctx,
 
    if (ctx->_Shader->Flags & GLSL_CACHE_INFO) {
       _mesa_sha1_format(sha1buf, prog->data->sha1);
-      fprintf(stderr, "loading shader program meta data from cache: %s\n",
-              sha1buf);
+      fprintf(stderr, "loading shader program meta data from %s cache: %s\n",
+              from_memory ? "memory" : "disk", sha1buf);
    }
 
    struct blob_reader metadata;
@@ -249,6 +397,7 @@ shader_cache_read_program_metadata(struct gl_context *ctx,
                  "cache item)\n");
       }
 
+      memory_cache_remove(prog->data->sha1);
       disk_cache_remove(cache, prog->data->sha1);
       compile_shaders(ctx, prog);
       free(buffer);
@@ -258,6 +407,9 @@ shader_cache_read_program_metadata(struct gl_context *ctx,
    /* This is used to flag a shader retrieved from cache */
    prog->data->LinkStatus = LINKING_SKIPPED;
 
+   if (!from_memory)
+      memory_cache_put(prog->data->sha1, buffer, size);
+
    free (buffer);
 
    return true;
@@ -784,7 +784,15 @@ cmp_func(const void *data1, const void *data2)
 struct set *
 nir_instr_set_create(void *mem_ctx)
 {
-   return _mesa_set_create(mem_ctx, hash_instr, cmp_func);
+   struct set *instr_set = _mesa_set_create(mem_ctx, hash_instr, cmp_func);
+
+   /* CSE does a lookup for every instruction and most of them miss, so
+    * filter on the hash tags before calling the expensive comparison.
+    */
+   if (instr_set)
+      _mesa_set_enable_group_probing(instr_set);
+
+   return instr_set;
 }
 
 void
@@ -489,13 +489,13 @@ vtn_process_block(struct vtn_builder *b,
    if (!list_is_empty(cf_list)) {
       /* vtn_process_block() acts like an iterator: it processes the given
        * block and then returns the next block to process.  For a given
-       * control-flow construct, vtn_build_cfg() calls vtn_process_block()
-       * repeatedly until it finally returns NULL.  Therefore, we know that
-       * the only blocks on which vtn_process_block() can be called are either
-       * the first block in a construct or a block that vtn_process_block()
-       * returned for the current construct.  If cf_list is empty then we know
-       * that we're processing the first block in the construct and we have to
-       * add it to the list.
+       * control-flow construct, vtn_structurize_function() calls
+       * vtn_process_block() repeatedly until it finally returns NULL.
+       * Therefore, we know that the only blocks on which vtn_process_block()
+       * can be called are either the first block in a construct or a block
+       * that vtn_process_block() returned for the current construct.  If
+       * cf_list is empty then we know that we're processing the first block
+       * in the construct and we have to add it to the list.
        *
        * If cf_list is not empty, then it must be the block returned by the
        * previous call to vtn_process_block().  We know a priori that
@@ -800,32 +800,37 @@ vtn_process_block(struct vtn_builder *b,
 void
 vtn_build_cfg(struct vtn_builder *b, const uint32_t *words, const uint32_t *end)
 {
+   /* Only the prepass runs over the whole module.  Structurizing a
+    * function's CFG is deferred to vtn_function_emit() so that functions
+    * which aren't reachable from the requested entry point never pay for
+    * it.  This matters for large modules containing many entry points.
+    */
    vtn_foreach_instruction(b, words, end,
                            vtn_cfg_handle_prepass_instruction);
+}
 
-   vtn_foreach_cf_node(func_node, &b->functions) {
-      struct vtn_function *func = vtn_cf_node_as_function(func_node);
-
-      /* We build the CFG for each function by doing a breadth-first search on
-       * the control-flow graph.  We keep track of our state using a worklist.
-       * Doing a BFS ensures that we visit each structured control-flow
-       * construct and its merge node before we visit the stuff inside the
-       * construct.
-       */
-      struct list_head work_list;
-      list_inithead(&work_list);
-      vtn_add_cfg_work_item(b, &work_list, &func->node, &func->body,
-                            func->start_block);
-
-      while (!list_is_empty(&work_list)) {
-         struct vtn_cfg_work_item *work =
-            list_first_entry(&work_list, struct vtn_cfg_work_item, link);
-         list_del(&work->link);
-
-         for (struct vtn_block *block = work->start_block; block; ) {
-            block = vtn_process_block(b, &work_list, work->cf_parent,
-                                      work->cf_list, block);
-         }
+static void
+vtn_structurize_function(struct vtn_builder *b, struct vtn_function *func)
+{
+   /* We build the CFG for each function by doing a breadth-first search on
+    * the control-flow graph.  We keep track of our state using a worklist.
+    * Doing a BFS ensures that we visit each structured control-flow
+    * construct and its merge node before we visit the stuff inside the
+    * construct.
+    */
+   struct list_head work_list;
+   list_inithead(&work_list);
+   vtn_add_cfg_work_item(b, &work_list, &func->node, &func->body,
+                         func->start_block);
+
+   while (!list_is_empty(&work_list)) {
+      struct vtn_cfg_work_item *work =
+         list_first_entry(&work_list, struct vtn_cfg_work_item, link);
+      list_del(&work->link);
+
+      for (struct vtn_block *block = work->start_block; block; ) {
+         block = vtn_process_block(b, &work_list, work->cf_parent,
+                                   work->cf_list, block);
       }
    }
 }
@@ -1174,6 +1179,8 @@ vtn_function_emit(struct vtn_builder *b, struct vtn_function *func,
    b->has_loop_continue = false;
    b->phi_table = _mesa_pointer_hash_table_create(b);
 
+   vtn_structurize_function(b, func);
+
    vtn_emit_cf_list(b, &func->body, NULL, NULL, instruction_handler);
 
    vtn_foreach_instruction(b, func->start_block->label, func->end,
@@ -101,6 +101,9 @@ static boolean TAG(do_cliptest)( struct pt_post_vs *pvs,
             out->clip_pos[i] = position[i];
          }
 
+#if defined(PIPE_ARCH_SSE)
+         mask = cliptest_frustum_sse(position, flags);
+#else
          /* Be careful with NaNs. Comparisons must be true for them. */
          /* Do the hardwired planes first:
           */
@@ -127,6 +130,7 @@ static boolean TAG(do_cliptest)( struct pt_post_vs *pvs,
             if (!( position[2]               >= 0)) mask |= (1<<4);
             if (!(-position[2] + position[3] >= 0)) mask |= (1<<5);
          }
+#endif
 
          if (flags & DO_CLIP_USER) {
             unsigned ucp_mask = ucp_enable;
@@ -28,6 +28,7 @@
 #include "util/u_memory.h"
 #include "util/u_math.h"
 #include "util/u_prim.h"
+#include "util/u_sse.h"
 #include "pipe/p_context.h"
 #include "draw/draw_context.h"
 #include "draw/draw_private.h"
@@ -71,6 +72,48 @@ dot4(const float *a, const float *b)
            a[3]*b[3]);
 }
 
+#if defined(PIPE_ARCH_SSE)
+
+/**
+ * Test a position against the hardwired xy and z planes, four planes per
+ * SSE compare. Returns bits 0-5 of the clip mask. Like the scalar code,
+ * a plane clips unless its distance is >= 0, so NaNs are clipped.
+ */
+static inline unsigned
+cliptest_frustum_sse(const float *position, unsigned flags)
+{
+   const __m128 pos = _mm_loadu_ps(position);
+   const __m128 w = _mm_shuffle_ps(pos, pos, _MM_SHUFFLE(3, 3, 3, 3));
+   const __m128 zero = _mm_setzero_ps();
+   unsigned mask = 0;
+
+   if (flags & (DO_CLIP_XY | DO_CLIP_XY_GUARD_BAND)) {
+      const float s = (flags & DO_CLIP_XY_GUARD_BAND) ? 0.5f : 1.0f;
+      const __m128 xxyy = _mm_shuffle_ps(pos, pos, _MM_SHUFFLE(1, 1, 0, 0));
+      const __m128 dist = _mm_add_ps(_mm_mul_ps(xxyy,
+                                                _mm_setr_ps(-s, s, -s, s)),
+                                     w);
+
+      mask |= _mm_movemask_ps(_mm_cmpnge_ps(dist, zero));
+   }
+
+   if (flags & (DO_CLIP_FULL_Z | DO_CLIP_HALF_Z)) {
+      const __m128 zzzz = _mm_shuffle_ps(pos, pos, _MM_SHUFFLE(2, 2, 2, 2));
+      /* The near plane of the half cube is z >= 0, so leave w out of it. */
+      const __m128 w_near = (flags & DO_CLIP_FULL_Z) ? w :
+         _mm_and_ps(w, _mm_castsi128_ps(_mm_setr_epi32(0, ~0, 0, 0)));
+      const __m128 dist = _mm_add_ps(_mm_mul_ps(zzzz,
+                                                _mm_setr_ps(1, -1, 0, 0)),
+                                     w_near);
+
+      mask |= (_mm_movemask_ps(_mm_cmpnge_ps(dist, zero)) & 0x3) << 4;
+   }
+
+   return mask;
+}
+
+#endif
+
 #define FLAGS (0)
 #define TAG(x) x##_none
 #include "draw_cliptest_tmp.h"
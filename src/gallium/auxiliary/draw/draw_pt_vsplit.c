@@ -31,7 +31,11 @@
 #include "draw/draw_pt.h"
 
 #define SEGMENT_SIZE 1024
-#define MAP_SIZE     256
+/* Large enough that the indices of a whole segment rarely collide, so that
+ * shared vertices are only fetched and shaded once per segment.  Must be a
+ * power of two.
+ */
+#define MAP_SIZE     SEGMENT_SIZE
 
 /* The largest possible index within an index buffer */
 #define MAX_ELT_IDX 0xffffffff
@@ -56,7 +60,11 @@ struct vsplit_frontend {
       /* map a fetch element to a draw element */
       unsigned fetches[MAP_SIZE];
       ushort draws[MAP_SIZE];
-      boolean has_max_fetch;
+      /* an entry is only valid if its generation is the current one, so
+       * clearing the cache doesn't have to touch the whole map
+       */
+      unsigned generations[MAP_SIZE];
+      unsigned generation;
 
       ushort num_fetch_elts;
       ushort num_draw_elts;
@@ -67,8 +75,11 @@ struct vsplit_frontend {
 static void
 vsplit_clear_cache(struct vsplit_frontend *vsplit)
 {
-   memset(vsplit->cache.fetches, 0xff, sizeof(vsplit->cache.fetches));
-   vsplit->cache.has_max_fetch = FALSE;
+   if (++vsplit->cache.generation == 0) {
+      memset(vsplit->cache.generations, 0,
+             sizeof(vsplit->cache.generations));
+      vsplit->cache.generation = 1;
+   }
    vsplit->cache.num_fetch_elts = 0;
    vsplit->cache.num_draw_elts = 0;
 }
@@ -89,12 +100,13 @@ vsplit_add_cache(struct vsplit_frontend *vsplit, unsigned fetch)
 {
    unsigned hash;
 
-   hash = fetch % MAP_SIZE;
+   hash = fetch & (MAP_SIZE - 1);
 
-   /* If the value isn't in the cache or it's an overflow due to the
-    * element bias */
-   if (vsplit->cache.fetches[hash] != fetch) {
+   /* If the value isn't in the cache */
+   if (vsplit->cache.generations[hash] != vsplit->cache.generation ||
+       vsplit->cache.fetches[hash] != fetch) {
       /* update cache */
+      vsplit->cache.generations[hash] = vsplit->cache.generation;
       vsplit->cache.fetches[hash] = fetch;
       vsplit->cache.draws[hash] = vsplit->cache.num_fetch_elts;
 
@@ -125,12 +137,6 @@ vsplit_add_cache_ubyte(struct vsplit_frontend *vsplit, const ubyte *elts,
    unsigned elt_idx;
    elt_idx = vsplit_get_base_idx(start, fetch);
    elt_idx = (unsigned)((int)(DRAW_GET_IDX(elts, elt_idx)) + elt_bias);
-   /* unlike the uint case this can only happen with elt_bias */
-   if (elt_bias && elt_idx == DRAW_MAX_FETCH_IDX && !vsplit->cache.has_max_fetch) {
-      unsigned hash = elt_idx % MAP_SIZE;
-      vsplit->cache.fetches[hash] = 0;
-      vsplit->cache.has_max_fetch = TRUE;
-   }
    vsplit_add_cache(vsplit, elt_idx);
 }
 
@@ -142,12 +148,6 @@ vsplit_add_cache_ushort(struct vsplit_frontend *vsplit, const ushort *elts,
    unsigned elt_idx;
    elt_idx = vsplit_get_base_idx(start, fetch);
    elt_idx = (unsigned)((int)(DRAW_GET_IDX(elts, elt_idx)) + elt_bias);
-   /* unlike the uint case this can only happen with elt_bias */
-   if (elt_bias && elt_idx == DRAW_MAX_FETCH_IDX && !vsplit->cache.has_max_fetch) {
-      unsigned hash = elt_idx % MAP_SIZE;
-      vsplit->cache.fetches[hash] = 0;
-      vsplit->cache.has_max_fetch = TRUE;
-   }
    vsplit_add_cache(vsplit, elt_idx);
 }
 
@@ -167,13 +167,6 @@ vsplit_add_cache_uint(struct vsplit_frontend *vsplit, const uint *elts,
     */
    elt_idx = vsplit_get_base_idx(start, fetch);
    elt_idx = (unsigned)((int)(DRAW_GET_IDX(elts, elt_idx)) + elt_bias);
-   /* Take care for DRAW_MAX_FETCH_IDX (since cache is initialized to -1). */
-   if (elt_idx == DRAW_MAX_FETCH_IDX && !vsplit->cache.has_max_fetch) {
-      unsigned hash = elt_idx % MAP_SIZE;
-      /* force update - any value will do except DRAW_MAX_FETCH_IDX */
-      vsplit->cache.fetches[hash] = 0;
-      vsplit->cache.has_max_fetch = TRUE;
-   }
    vsplit_add_cache(vsplit, elt_idx);
 }
 
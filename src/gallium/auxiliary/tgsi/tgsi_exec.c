@@ -1705,6 +1705,68 @@ get_index_registers(const struct tgsi_exec_machine *mach,
 }
 
 
+/**
+ * Fetch a directly addressed register without building per-channel index
+ * vectors. This covers almost all sources, so it's worth avoiding the
+ * per-channel switch in fetch_src_file_channel().
+ *
+ * \return false if the register must go through the generic path.
+ */
+static inline bool
+fetch_src_file_channel_direct(const struct tgsi_exec_machine *mach,
+                              const struct tgsi_full_src_register *reg,
+                              const uint swizzle,
+                              union tgsi_exec_channel *chan)
+{
+   const int index = reg->Register.Index;
+   const int index2D =
+      reg->Register.Dimension ? reg->Dimension.Index : 0;
+   uint i;
+
+   if (reg->Register.Indirect ||
+       (reg->Register.Dimension && reg->Dimension.Indirect))
+      return false;
+
+   switch (reg->Register.File) {
+   case TGSI_FILE_TEMPORARY:
+      assert(index < TGSI_EXEC_NUM_TEMPS);
+      assert(index2D == 0);
+      *chan = mach->Temps[index].xyzw[swizzle];
+      return true;
+
+   case TGSI_FILE_IMMEDIATE:
+      assert(index >= 0 && index < (int)mach->ImmLimit);
+      assert(index2D == 0);
+      for (i = 0; i < TGSI_QUAD_SIZE; i++)
+         chan->f[i] = mach->Imms[index][swizzle];
+      return true;
+
+   case TGSI_FILE_CONSTANT: {
+      const int pos = index * 4 + swizzle;
+      uint value = 0;
+
+      assert(index2D >= 0 && index2D < PIPE_MAX_CONSTANT_BUFFERS);
+      assert(mach->Consts[index2D]);
+
+      /* const buffer bounds check */
+      if (index >= 0 && pos < (int) mach->ConstsSize[index2D])
+         value = ((const uint *)mach->Consts[index2D])[pos];
+      for (i = 0; i < TGSI_QUAD_SIZE; i++)
+         chan->u[i] = value;
+      return true;
+   }
+
+   case TGSI_FILE_INPUT:
+      assert(index2D * TGSI_EXEC_MAX_INPUT_ATTRIBS + index >= 0);
+      *chan = mach->Inputs[index2D * TGSI_EXEC_MAX_INPUT_ATTRIBS +
+                           index].xyzw[swizzle];
+      return true;
+
+   default:
+      return false;
+   }
+}
+
 static void
 fetch_source_d(const struct tgsi_exec_machine *mach,
                union tgsi_exec_channel *chan,
@@ -1715,10 +1777,12 @@ fetch_source_d(const struct tgsi_exec_machine *mach,
    union tgsi_exec_channel index2D;
    uint swizzle;
 
-   get_index_registers(mach, reg, &index, &index2D);
+   swizzle = tgsi_util_get_full_src_register_swizzle( reg, chan_index );
+   if (fetch_src_file_channel_direct(mach, reg, swizzle, chan))
+      return;
 
+   get_index_registers(mach, reg, &index, &index2D);
 
-   swizzle = tgsi_util_get_full_src_register_swizzle( reg, chan_index );
    fetch_src_file_channel(mach,
                           reg->Register.File,
                           swizzle,
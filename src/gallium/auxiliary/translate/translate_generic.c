@@ -44,6 +44,12 @@ typedef void (*fetch_func)(void *dst,
                            const uint8_t *src,
                            unsigned i, unsigned j);
 typedef void (*emit_func)(const void *attrib, void *ptr);
+typedef void (*unpack_func)(void *dst, unsigned dst_stride,
+                            const uint8_t *src, unsigned src_stride,
+                            unsigned width, unsigned height);
+
+/* Number of vertices converted at once by generic_run. */
+#define GENERIC_BATCH_SIZE 64
 
 
 
@@ -54,6 +60,7 @@ struct translate_generic {
       enum translate_element_type type;
 
       fetch_func fetch;
+      unpack_func unpack; /* same as fetch, but for a range of vertices */
       unsigned buffer;
       unsigned input_offset;
       unsigned instance_divisor;
@@ -586,6 +593,66 @@ get_emit_func(enum pipe_format format)
    }
 }
 
+static ALWAYS_INLINE void
+generic_run_one_attrib(struct translate_generic *tg,
+                       unsigned attr,
+                       unsigned elt,
+                       unsigned start_instance,
+                       unsigned instance_id,
+                       void *vert)
+{
+   float data[4];
+   uint8_t *dst = (uint8_t *)vert + tg->attrib[attr].output_offset;
+
+   if (tg->attrib[attr].type == TRANSLATE_ELEMENT_NORMAL) {
+      const uint8_t *src;
+      unsigned index;
+      int copy_size;
+
+      if (tg->attrib[attr].instance_divisor) {
+         index = start_instance;
+         index += (instance_id  / tg->attrib[attr].instance_divisor);
+         /* XXX we need to clamp the index here too, but to a
+          * per-array max value, not the draw->pt.max_index value
+          * that's being given to us via translate->set_buffer().
+          */
+      }
+      else {
+         index = elt;
+         /* clamp to avoid going out of bounds */
+         index = MIN2(index, tg->attrib[attr].max_index);
+      }
+
+      src = tg->attrib[attr].input_ptr +
+            (ptrdiff_t)tg->attrib[attr].input_stride * index;
+
+      copy_size = tg->attrib[attr].copy_size;
+      if (likely(copy_size >= 0)) {
+         memcpy(dst, src, copy_size);
+      } else {
+         tg->attrib[attr].fetch(data, src, 0, 0);
+
+         if (0)
+            debug_printf("Fetch linear attr %d  from %p  stride %d  index %d: "
+                      " %f, %f, %f, %f \n",
+                      attr,
+                      tg->attrib[attr].input_ptr,
+                      tg->attrib[attr].input_stride,
+                      index,
+                      data[0], data[1],data[2], data[3]);
+
+         tg->attrib[attr].emit(data, dst);
+      }
+   } else {
+      if (likely(tg->attrib[attr].copy_size >= 0)) {
+         memcpy(data, &instance_id, 4);
+      } else {
+         data[0] = (float)instance_id;
+         tg->attrib[attr].emit(data, dst);
+      }
+   }
+}
+
 static ALWAYS_INLINE void PIPE_CDECL
 generic_run_one(struct translate_generic *tg,
                 unsigned elt,
@@ -596,58 +663,8 @@ generic_run_one(struct translate_generic *tg,
    unsigned nr_attrs = tg->nr_attrib;
    unsigned attr;
 
-   for (attr = 0; attr < nr_attrs; attr++) {
-      float data[4];
-      uint8_t *dst = (uint8_t *)vert + tg->attrib[attr].output_offset;
-
-      if (tg->attrib[attr].type == TRANSLATE_ELEMENT_NORMAL) {
-         const uint8_t *src;
-         unsigned index;
-         int copy_size;
-
-         if (tg->attrib[attr].instance_divisor) {
-            index = start_instance;
-            index += (instance_id  / tg->attrib[attr].instance_divisor);
-            /* XXX we need to clamp the index here too, but to a
-             * per-array max value, not the draw->pt.max_index value
-             * that's being given to us via translate->set_buffer().
-             */
-         }
-         else {
-            index = elt;
-            /* clamp to avoid going out of bounds */
-            index = MIN2(index, tg->attrib[attr].max_index);
-         }
-
-         src = tg->attrib[attr].input_ptr +
-               (ptrdiff_t)tg->attrib[attr].input_stride * index;
-
-         copy_size = tg->attrib[attr].copy_size;
-         if (likely(copy_size >= 0)) {
-            memcpy(dst, src, copy_size);
-         } else {
-            tg->attrib[attr].fetch(data, src, 0, 0);
-
-            if (0)
-               debug_printf("Fetch linear attr %d  from %p  stride %d  index %d: "
-                         " %f, %f, %f, %f \n",
-                         attr,
-                         tg->attrib[attr].input_ptr,
-                         tg->attrib[attr].input_stride,
-                         index,
-                         data[0], data[1],data[2], data[3]);
-
-            tg->attrib[attr].emit(data, dst);
-         }
-      } else {
-         if (likely(tg->attrib[attr].copy_size >= 0)) {
-            memcpy(data, &instance_id, 4);
-         } else {
-            data[0] = (float)instance_id;
-            tg->attrib[attr].emit(data, dst);
-         }
-      }
-   }
+   for (attr = 0; attr < nr_attrs; attr++)
+      generic_run_one_attrib(tg, attr, elt, start_instance, instance_id, vert);
 }
 
 /**
@@ -707,6 +724,64 @@ generic_run_elts8(struct translate *translate,
    }
 }
 
+/**
+ * Convert a range of at most GENERIC_BATCH_SIZE consecutive vertices
+ * attribute by attribute. Converted attributes are unpacked with one call
+ * per batch instead of one fetch call per vertex.
+ */
+static void
+generic_run_batch(struct translate_generic *tg,
+                  unsigned start,
+                  unsigned count,
+                  unsigned start_instance,
+                  unsigned instance_id,
+                  uint8_t *output_buffer)
+{
+   const unsigned output_stride = tg->translate.key.output_stride;
+   unsigned attr, i;
+
+   assert(count <= GENERIC_BATCH_SIZE);
+
+   for (attr = 0; attr < tg->nr_attrib; attr++) {
+      uint8_t *dst = output_buffer + tg->attrib[attr].output_offset;
+      float data[GENERIC_BATCH_SIZE][4];
+
+      if (tg->attrib[attr].type != TRANSLATE_ELEMENT_NORMAL ||
+          tg->attrib[attr].instance_divisor) {
+         /* The value is the same for all vertices. */
+         uint8_t *vert = output_buffer;
+
+         for (i = 0; i < count; i++) {
+            generic_run_one_attrib(tg, attr, start + i, start_instance,
+                                   instance_id, vert);
+            vert += output_stride;
+         }
+         continue;
+      }
+
+      const uint8_t *src = tg->attrib[attr].input_ptr +
+                           (ptrdiff_t)tg->attrib[attr].input_stride * start;
+      const unsigned input_stride = tg->attrib[attr].input_stride;
+      const int copy_size = tg->attrib[attr].copy_size;
+
+      if (copy_size >= 0) {
+         for (i = 0; i < count; i++) {
+            memcpy(dst, src, copy_size);
+            src += input_stride;
+            dst += output_stride;
+         }
+      } else {
+         tg->attrib[attr].unpack(data, sizeof(data[0]), src, input_stride,
+                                 1, count);
+
+         for (i = 0; i < count; i++) {
+            tg->attrib[attr].emit(data[i], dst);
+            dst += output_stride;
+         }
+      }
+   }
+}
+
 static void PIPE_CDECL
 generic_run(struct translate *translate,
             unsigned start,
@@ -717,8 +792,30 @@ generic_run(struct translate *translate,
 {
    struct translate_generic *tg = translate_generic(translate);
    char *vert = output_buffer;
+   bool batch = count > 1;
    unsigned i;
 
+   /* The batched path can't clamp indices or use fetch-only formats. */
+   for (i = 0; i < tg->nr_attrib && batch; i++) {
+      if (tg->attrib[i].type == TRANSLATE_ELEMENT_NORMAL &&
+          !tg->attrib[i].instance_divisor &&
+          (start + count - 1 > tg->attrib[i].max_index ||
+           (tg->attrib[i].copy_size < 0 && !tg->attrib[i].unpack)))
+         batch = false;
+   }
+
+   if (batch) {
+      const unsigned output_stride = tg->translate.key.output_stride;
+
+      for (i = 0; i < count; i += GENERIC_BATCH_SIZE) {
+         generic_run_batch(tg, start + i,
+                           MIN2(count - i, GENERIC_BATCH_SIZE),
+                           start_instance, instance_id,
+                           (uint8_t *)vert + i * output_stride);
+      }
+      return;
+   }
+
    for (i = 0; i < count; i++) {
       generic_run_one(tg, start + i, start_instance, instance_id, vert);
       vert += tg->translate.key.output_stride;
@@ -826,6 +923,7 @@ translate_generic_create(const struct translate_key *key)
          assert(unpack->fetch_rgba_float);
          tg->attrib[i].fetch = (fetch_func)unpack->fetch_rgba_float;
       }
+      tg->attrib[i].unpack = unpack->unpack_rgba;
 
       tg->attrib[i].buffer = key->element[i].input_buffer;
       tg->attrib[i].input_offset = key->element[i].input_offset;
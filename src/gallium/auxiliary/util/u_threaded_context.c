@@ -110,6 +110,7 @@ tc_batch_flush(struct threaded_context *tc)
    tc_debug_check(tc);
    tc->bytes_mapped_estimate = 0;
    p_atomic_add(&tc->num_offloaded_slots, next->num_total_call_slots);
+   p_atomic_inc(&tc->num_batches);
 
    if (next->token) {
       next->token->tc = NULL;
@@ -140,6 +141,17 @@ tc_add_sized_call(struct threaded_context *tc, enum tc_call_id id,
       tc_batch_flush(tc);
       next = &tc->batch_slots[tc->next];
       tc_assert(next->num_total_call_slots == 0);
+   } else if (next->num_total_call_slots >= TC_EARLY_FLUSH_CALLS &&
+              !next->token &&
+              util_queue_fence_is_signalled(&tc->batch_slots[tc->last].fence)) {
+      /* A batch with a token has a deferred fence pointing to it, and the
+       * flush call that the fence waits for may be the call being added
+       * now, so it must stay in this batch.
+       */
+      p_atomic_inc(&tc->num_early_flushes);
+      tc_batch_flush(tc);
+      next = &tc->batch_slots[tc->next];
+      tc_assert(next->num_total_call_slots == 0);
    }
 
    tc_assert(util_queue_fence_is_signalled(&next->fence));
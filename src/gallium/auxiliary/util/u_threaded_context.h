@@ -222,6 +222,13 @@ struct tc_unflushed_batch_token;
  */
 #define TC_CALLS_PER_BATCH    768
 
+/* If the driver thread is idle, batches with at least this many call slots
+ * are flushed before they are full, so that the driver thread doesn't
+ * starve while the application thread is the bottleneck. If the driver
+ * thread is busy, batches are only flushed when full.
+ */
+#define TC_EARLY_FLUSH_CALLS  (TC_CALLS_PER_BATCH / 4)
+
 /* Threshold for when to use the queue or sync. */
 #define TC_MAX_STRING_MARKER_BYTES  512
 
@@ -360,6 +367,8 @@ struct threaded_context {
    unsigned num_offloaded_slots;
    unsigned num_direct_slots;
    unsigned num_syncs;
+   unsigned num_batches;
+   unsigned num_early_flushes;
 
    /* Estimation of how much vram/gtt bytes are mmap'd in
     * the current tc_batch.
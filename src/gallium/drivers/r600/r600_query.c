@@ -153,6 +153,12 @@ static bool r600_query_sw_begin(struct r600_common_context *rctx,
 	case R600_QUERY_TC_NUM_SYNCS:
 		query->begin_result = rctx->tc ? rctx->tc->num_syncs : 0;
 		break;
+	case R600_QUERY_TC_NUM_BATCHES:
+		query->begin_result = rctx->tc ? rctx->tc->num_batches : 0;
+		break;
+	case R600_QUERY_TC_NUM_EARLY_FLUSHES:
+		query->begin_result = rctx->tc ? rctx->tc->num_early_flushes : 0;
+		break;
 	case R600_QUERY_REQUESTED_VRAM:
 	case R600_QUERY_REQUESTED_GTT:
 	case R600_QUERY_MAPPED_VRAM:
@@ -305,6 +311,12 @@ static bool r600_query_sw_end(struct r600_common_context *rctx,
 	case R600_QUERY_TC_NUM_SYNCS:
 		query->end_result = rctx->tc ? rctx->tc->num_syncs : 0;
 		break;
+	case R600_QUERY_TC_NUM_BATCHES:
+		query->end_result = rctx->tc ? rctx->tc->num_batches : 0;
+		break;
+	case R600_QUERY_TC_NUM_EARLY_FLUSHES:
+		query->end_result = rctx->tc ? rctx->tc->num_early_flushes : 0;
+		break;
 	case R600_QUERY_REQUESTED_VRAM:
 	case R600_QUERY_REQUESTED_GTT:
 	case R600_QUERY_MAPPED_VRAM:
@@ -1968,6 +1980,8 @@ static const struct pipe_driver_query_info r600_driver_query_list[] = {
 	X("tc-offloaded-slots",		TC_OFFLOADED_SLOTS,     UINT64, AVERAGE),
 	X("tc-direct-slots",		TC_DIRECT_SLOTS,	UINT64, AVERAGE),
 	X("tc-num-syncs",		TC_NUM_SYNCS,		UINT64, AVERAGE),
+	X("tc-num-batches",		TC_NUM_BATCHES,		UINT64, AVERAGE),
+	X("tc-num-early-flushes",	TC_NUM_EARLY_FLUSHES,	UINT64, AVERAGE),
 	X("CS-thread-busy",		CS_THREAD_BUSY,		UINT64, AVERAGE),
 	X("gallium-thread-busy",	GALLIUM_THREAD_BUSY,	UINT64, AVERAGE),
 	X("requested-VRAM",		REQUESTED_VRAM,		BYTES, AVERAGE),
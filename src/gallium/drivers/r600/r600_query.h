@@ -59,6 +59,8 @@ enum {
 	R600_QUERY_TC_OFFLOADED_SLOTS,
 	R600_QUERY_TC_DIRECT_SLOTS,
 	R600_QUERY_TC_NUM_SYNCS,
+	R600_QUERY_TC_NUM_BATCHES,
+	R600_QUERY_TC_NUM_EARLY_FLUSHES,
 	R600_QUERY_CS_THREAD_BUSY,
 	R600_QUERY_GALLIUM_THREAD_BUSY,
 	R600_QUERY_REQUESTED_VRAM,
@@ -198,6 +198,12 @@ static bool si_query_sw_begin(struct si_context *sctx, struct si_query *squery)
    case SI_QUERY_TC_NUM_SYNCS:
       query->begin_result = sctx->tc ? sctx->tc->num_syncs : 0;
       break;
+   case SI_QUERY_TC_NUM_BATCHES:
+      query->begin_result = sctx->tc ? sctx->tc->num_batches : 0;
+      break;
+   case SI_QUERY_TC_NUM_EARLY_FLUSHES:
+      query->begin_result = sctx->tc ? sctx->tc->num_early_flushes : 0;
+      break;
    case SI_QUERY_REQUESTED_VRAM:
    case SI_QUERY_REQUESTED_GTT:
    case SI_QUERY_MAPPED_VRAM:
@@ -380,6 +386,12 @@ static bool si_query_sw_end(struct si_context *sctx, struct si_query *squery)
    case SI_QUERY_TC_NUM_SYNCS:
       query->end_result = sctx->tc ? sctx->tc->num_syncs : 0;
       break;
+   case SI_QUERY_TC_NUM_BATCHES:
+      query->end_result = sctx->tc ? sctx->tc->num_batches : 0;
+      break;
+   case SI_QUERY_TC_NUM_EARLY_FLUSHES:
+      query->end_result = sctx->tc ? sctx->tc->num_early_flushes : 0;
+      break;
    case SI_QUERY_REQUESTED_VRAM:
    case SI_QUERY_REQUESTED_GTT:
    case SI_QUERY_MAPPED_VRAM:
@@ -1685,6 +1697,8 @@ static struct pipe_driver_query_info si_driver_query_list[] = {
    X("tc-offloaded-slots", TC_OFFLOADED_SLOTS, UINT64, AVERAGE),
    X("tc-direct-slots", TC_DIRECT_SLOTS, UINT64, AVERAGE),
    X("tc-num-syncs", TC_NUM_SYNCS, UINT64, AVERAGE),
+   X("tc-num-batches", TC_NUM_BATCHES, UINT64, AVERAGE),
+   X("tc-num-early-flushes", TC_NUM_EARLY_FLUSHES, UINT64, AVERAGE),
    X("CS-thread-busy", CS_THREAD_BUSY, UINT64, AVERAGE),
    X("gallium-thread-busy", GALLIUM_THREAD_BUSY, UINT64, AVERAGE),
    X("requested-VRAM", REQUESTED_VRAM, BYTES, AVERAGE),
@@ -62,6 +62,8 @@ enum
    SI_QUERY_TC_OFFLOADED_SLOTS,
    SI_QUERY_TC_DIRECT_SLOTS,
    SI_QUERY_TC_NUM_SYNCS,
+   SI_QUERY_TC_NUM_BATCHES,
+   SI_QUERY_TC_NUM_EARLY_FLUSHES,
    SI_QUERY_CS_THREAD_BUSY,
    SI_QUERY_GALLIUM_THREAD_BUSY,
    SI_QUERY_REQUESTED_VRAM,
@@ -2142,8 +2142,10 @@ current_not_ready:
     * Only wait if we are in a draw call. Don't wait if we are
     * in a compiler thread.
     */
-   if (thread_index < 0)
+   if (thread_index < 0) {
+      util_queue_promote_job(&sscreen->shader_compiler_queue, &sel->ready);
       util_queue_fence_wait(&sel->ready);
+   }
 
    simple_mtx_lock(&sel->mutex);
 
@@ -35,6 +35,7 @@
 #include "util/u_memory.h"
 #include "util/format/u_format.h"
 #include "util/u_dual_blend.h"
+#include "util/u_sse.h"
 #include "sp_context.h"
 #include "sp_state.h"
 #include "sp_quad.h"
@@ -70,6 +71,79 @@ blend_quad_stage(struct quad_stage *stage)
 }
 
 
+/**
+ * Read the colors of a quad's four pixels from a tile, converting them
+ * from the tile's per-pixel layout to the per-channel quad layout.
+ */
+static inline void
+get_quad_dest(const struct softpipe_cached_tile *tile, int itx, int ity,
+              float (*dest)[TGSI_QUAD_SIZE])
+{
+#if defined(PIPE_ARCH_SSE)
+   __m128 p0 = _mm_loadu_ps(tile->data.color[ity][itx]);
+   __m128 p1 = _mm_loadu_ps(tile->data.color[ity][itx + 1]);
+   __m128 p2 = _mm_loadu_ps(tile->data.color[ity + 1][itx]);
+   __m128 p3 = _mm_loadu_ps(tile->data.color[ity + 1][itx + 1]);
+
+   _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+   _mm_storeu_ps(dest[0], p0);
+   _mm_storeu_ps(dest[1], p1);
+   _mm_storeu_ps(dest[2], p2);
+   _mm_storeu_ps(dest[3], p3);
+#else
+   uint i, j;
+
+   for (j = 0; j < TGSI_QUAD_SIZE; j++) {
+      int x = itx + (j & 1);
+      int y = ity + (j >> 1);
+      for (i = 0; i < 4; i++) {
+         dest[i][j] = tile->data.color[y][x][i];
+      }
+   }
+#endif
+}
+
+
+/**
+ * Write the colors of the covered pixels of a quad to a tile.
+ */
+static inline void
+put_quad_color(struct softpipe_cached_tile *tile, int itx, int ity,
+               unsigned mask, float (*quadColor)[4])
+{
+#if defined(PIPE_ARCH_SSE)
+   __m128 p[4];
+
+   p[0] = _mm_loadu_ps(quadColor[0]);
+   p[1] = _mm_loadu_ps(quadColor[1]);
+   p[2] = _mm_loadu_ps(quadColor[2]);
+   p[3] = _mm_loadu_ps(quadColor[3]);
+   _MM_TRANSPOSE4_PS(p[0], p[1], p[2], p[3]);
+
+   if (mask & 1)
+      _mm_storeu_ps(tile->data.color[ity][itx], p[0]);
+   if (mask & 2)
+      _mm_storeu_ps(tile->data.color[ity][itx + 1], p[1]);
+   if (mask & 4)
+      _mm_storeu_ps(tile->data.color[ity + 1][itx], p[2]);
+   if (mask & 8)
+      _mm_storeu_ps(tile->data.color[ity + 1][itx + 1], p[3]);
+#else
+   uint i, j;
+
+   for (j = 0; j < TGSI_QUAD_SIZE; j++) {
+      if (mask & (1 << j)) {
+         int x = itx + (j & 1);
+         int y = ity + (j >> 1);
+         for (i = 0; i < 4; i++) { /* loop over color chans */
+            tile->data.color[y][x][i] = quadColor[i][j];
+         }
+      }
+   }
+#endif
+}
+
+
 #define VEC4_COPY(DST, SRC) \
 do { \
     DST[0] = SRC[0]; \
@@ -975,13 +1049,7 @@ blend_fallback(struct quad_stage *qs,
 
             /* get/swizzle dest colors
              */
-            for (j = 0; j < TGSI_QUAD_SIZE; j++) {
-               int x = itx + (j & 1);
-               int y = ity + (j >> 1);
-               for (i = 0; i < 4; i++) {
-                  dest[i][j] = tile->data.color[y][x][i];
-               }
-            }
+            get_quad_dest(tile, itx, ity, dest);
 
 
             if (blend->logicop_enable) {
@@ -1007,15 +1075,7 @@ blend_fallback(struct quad_stage *qs,
 
             /* Output color values
              */
-            for (j = 0; j < TGSI_QUAD_SIZE; j++) {
-               if (quad->inout.mask & (1 << j)) {
-                  int x = itx + (j & 1);
-                  int y = ity + (j >> 1);
-                  for (i = 0; i < 4; i++) { /* loop over color chans */
-                     tile->data.color[y][x][i] = quadColor[i][j];
-                  }
-               }
-            }
+            put_quad_color(tile, itx, ity, quad->inout.mask, quadColor);
          }
       }
    }
@@ -1032,7 +1092,7 @@ blend_single_add_src_alpha_inv_src_alpha(struct quad_stage *qs,
    float one_minus_alpha[TGSI_QUAD_SIZE];
    float dest[4][TGSI_QUAD_SIZE];
    float source[4][TGSI_QUAD_SIZE];
-   uint i, j, q;
+   uint q;
 
    struct softpipe_cached_tile *tile
       = sp_get_cached_tile(qs->softpipe->cbuf_cache[0],
@@ -1047,13 +1107,7 @@ blend_single_add_src_alpha_inv_src_alpha(struct quad_stage *qs,
       const int ity = (quad->input.y0 & (TILE_SIZE-1));
       
       /* get/swizzle dest colors */
-      for (j = 0; j < TGSI_QUAD_SIZE; j++) {
-         int x = itx + (j & 1);
-         int y = ity + (j >> 1);
-         for (i = 0; i < 4; i++) {
-            dest[i][j] = tile->data.color[y][x][i];
-         }
-      }
+      get_quad_dest(tile, itx, ity, dest);
 
       /* If fixed-point dest color buffer, need to clamp the incoming
        * fragment colors now.
@@ -1087,15 +1141,7 @@ blend_single_add_src_alpha_inv_src_alpha(struct quad_stage *qs,
 
       rebase_colors(bqs->base_format[0], quadColor);
 
-      for (j = 0; j < TGSI_QUAD_SIZE; j++) {
-         if (quad->inout.mask & (1 << j)) {
-            int x = itx + (j & 1);
-            int y = ity + (j >> 1);
-            for (i = 0; i < 4; i++) { /* loop over color chans */
-               tile->data.color[y][x][i] = quadColor[i][j];
-            }
-         }
-      }
+      put_quad_color(tile, itx, ity, quad->inout.mask, quadColor);
    }
 }
 
@@ -1106,7 +1152,7 @@ blend_single_add_one_one(struct quad_stage *qs,
 {
    const struct blend_quad_stage *bqs = blend_quad_stage(qs);
    float dest[4][TGSI_QUAD_SIZE];
-   uint i, j, q;
+   uint q;
 
    struct softpipe_cached_tile *tile
       = sp_get_cached_tile(qs->softpipe->cbuf_cache[0],
@@ -1120,13 +1166,7 @@ blend_single_add_one_one(struct quad_stage *qs,
       const int ity = (quad->input.y0 & (TILE_SIZE-1));
       
       /* get/swizzle dest colors */
-      for (j = 0; j < TGSI_QUAD_SIZE; j++) {
-         int x = itx + (j & 1);
-         int y = ity + (j >> 1);
-         for (i = 0; i < 4; i++) {
-            dest[i][j] = tile->data.color[y][x][i];
-         }
-      }
+      get_quad_dest(tile, itx, ity, dest);
      
       /* If fixed-point dest color buffer, need to clamp the incoming
        * fragment colors now.
@@ -1149,15 +1189,7 @@ blend_single_add_one_one(struct quad_stage *qs,
 
       rebase_colors(bqs->base_format[0], quadColor);
 
-      for (j = 0; j < TGSI_QUAD_SIZE; j++) {
-         if (quad->inout.mask & (1 << j)) {
-            int x = itx + (j & 1);
-            int y = ity + (j >> 1);
-            for (i = 0; i < 4; i++) { /* loop over color chans */
-               tile->data.color[y][x][i] = quadColor[i][j];
-            }
-         }
-      }
+      put_quad_color(tile, itx, ity, quad->inout.mask, quadColor);
    }
 }
 
@@ -1174,7 +1206,7 @@ single_output_color(struct quad_stage *qs,
                     unsigned nr)
 {
    const struct blend_quad_stage *bqs = blend_quad_stage(qs);
-   uint i, j, q;
+   uint q;
 
    struct softpipe_cached_tile *tile
       = sp_get_cached_tile(qs->softpipe->cbuf_cache[0],
@@ -1192,15 +1224,7 @@ single_output_color(struct quad_stage *qs,
 
       rebase_colors(bqs->base_format[0], quadColor);
 
-      for (j = 0; j < TGSI_QUAD_SIZE; j++) {
-         if (quad->inout.mask & (1 << j)) {
-            int x = itx + (j & 1);
-            int y = ity + (j >> 1);
-            for (i = 0; i < 4; i++) { /* loop over color chans */
-               tile->data.color[y][x][i] = quadColor[i][j];
-            }
-         }
-      }
+      put_quad_color(tile, itx, ity, quad->inout.mask, quadColor);
    }
 }
 
@@ -342,6 +342,8 @@ sp_tile_cache_flush_clear(struct softpipe_tile_cache *tc, int layer)
    struct pipe_transfer *pt = tc->transfer[layer];
    const uint w = tc->transfer[layer]->box.width;
    const uint h = tc->transfer[layer]->box.height;
+   const void *clear_data = tc->tile->data.any;
+   void *packed = NULL;
    uint x, y;
    uint numCleared = 0;
 
@@ -352,6 +354,25 @@ sp_tile_cache_flush_clear(struct softpipe_tile_cache *tc, int layer)
       clear_tile(tc->tile, pt->resource->format, tc->clear_val);
    } else {
       clear_tile_rgba(tc->tile, pt->resource->format, &tc->clear_color);
+
+      /* Convert the clear color to the surface format once instead of for
+       * every cleared tile, and copy the packed tile below.
+       */
+      if (util_format_get_blocksize(tc->surface->format) ==
+          util_format_get_blocksize(pt->resource->format)) {
+         packed = MALLOC(util_format_get_stride(tc->surface->format,
+                                                TILE_SIZE) * TILE_SIZE);
+      }
+      if (packed) {
+         util_format_write_4(tc->surface->format,
+                             tc->tile->data.color,
+                             TILE_SIZE * 4 * sizeof(float),
+                             packed,
+                             util_format_get_stride(tc->surface->format,
+                                                    TILE_SIZE),
+                             0, 0, TILE_SIZE, TILE_SIZE);
+         clear_data = packed;
+      }
    }
 
    /* push the tile to all positions marked as clear */
@@ -361,10 +382,10 @@ sp_tile_cache_flush_clear(struct softpipe_tile_cache *tc, int layer)
 
          if (is_clear_flag_set(tc->clear_flags, addr, tc->clear_flags_size)) {
             /* write the scratch tile to the surface */
-            if (tc->depth_stencil) {
+            if (tc->depth_stencil || packed) {
                pipe_put_tile_raw(pt, tc->transfer_map[layer],
                                  x, y, TILE_SIZE, TILE_SIZE,
-                                 tc->tile->data.any, 0/*STRIDE*/);
+                                 clear_data, 0/*STRIDE*/);
             }
             else {
                pipe_put_tile_rgba(pt, tc->transfer_map[layer],
@@ -377,6 +398,7 @@ sp_tile_cache_flush_clear(struct softpipe_tile_cache *tc, int layer)
       }
    }
 
+   FREE(packed);
 
 #if 0
    debug_printf("num cleared: %u\n", numCleared);
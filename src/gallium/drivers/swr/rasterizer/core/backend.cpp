@@ -261,6 +261,8 @@ void BackendNullPS(DRAW_CONTEXT*        pDC,
     ///@todo: handle center multisample pattern
     RDTSC_BEGIN(pDC->pContext->pBucketMgr, BESetup, pDC->drawId);
 
+    UPDATE_STAT_BE(BackendTiles, 1);
+
     const API_STATE& state = GetApiState(pDC);
 
     BarycentricCoeffs coeffs;
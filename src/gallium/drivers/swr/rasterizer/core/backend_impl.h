@@ -1029,6 +1029,8 @@ void BackendPixelRate(DRAW_CONTEXT*        pDC,
     RDTSC_BEGIN(pDC->pContext->pBucketMgr, BEPixelRateBackend, pDC->drawId);
     RDTSC_BEGIN(pDC->pContext->pBucketMgr, BESetup, pDC->drawId);
 
+    UPDATE_STAT_BE(BackendTiles, 1);
+
     const API_STATE& state = GetApiState(pDC);
 
     BarycentricCoeffs coeffs;
@@ -1117,8 +1119,11 @@ void BackendPixelRate(DRAW_CONTEXT*        pDC,
             // Early-Z?
             if (T::bCanEarlyZ && !T::bForcedSampleCount)
             {
+                uint32_t numLanes = _mm_popcnt_u32(_simd_movemask_ps(activeLanes));
                 uint32_t depthPassCount = PixelRateZTest(activeLanes, psContext, BEEarlyDepthTest);
                 UPDATE_STAT_BE(DepthPassCount, depthPassCount);
+                UPDATE_STAT_BE(EarlyZRejects,
+                               numLanes - _mm_popcnt_u32(_simd_movemask_ps(activeLanes)));
                 AR_EVENT(EarlyDepthInfoPixelRate(depthPassCount, _simd_movemask_ps(activeLanes)));
             }
 
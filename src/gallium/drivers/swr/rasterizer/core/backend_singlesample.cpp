@@ -48,6 +48,8 @@ void BackendSingleSample(DRAW_CONTEXT*        pDC,
     RDTSC_BEGIN(pDC->pContext->pBucketMgr, BESingleSampleBackend, pDC->drawId);
     RDTSC_BEGIN(pDC->pContext->pBucketMgr, BESetup, pDC->drawId);
 
+    UPDATE_STAT_BE(BackendTiles, 1);
+
     void* pWorkerData = pDC->pContext->threadPool.pThreadData[workerId].pWorkerPrivateData;
 
     const API_STATE& state = GetApiState(pDC);
@@ -160,6 +162,9 @@ void BackendSingleSample(DRAW_CONTEXT*        pDC,
                                                                _simd_movemask_ps(stencilPassMask),
                                                                _simd_movemask_ps(vCoverageMask)));
                     RDTSC_END(pDC->pContext->pBucketMgr, BEEarlyDepthTest, 0);
+                    UPDATE_STAT_BE(EarlyZRejects,
+                                   _mm_popcnt_u32(_simd_movemask_ps(vCoverageMask)) -
+                                       _mm_popcnt_u32(_simd_movemask_ps(depthPassMask)));
 
                     // early-exit if no pixels passed depth or earlyZ is forced on
                     if (state.psState.forceEarlyZ || !_simd_movemask_ps(depthPassMask))
@@ -614,6 +614,9 @@ OSALIGNLINE(struct) SWR_STATS
     uint64_t PsInvocations; // Number of Pixel Shader invocations
     uint64_t CsInvocations; // Number of Compute Shader invocations
 
+    // Backend Stats
+    uint64_t BackendTiles;  // Number of raster tiles the backend processed for a primitive
+    uint64_t EarlyZRejects; // Number of pixels (samples at sample rate) failing early depth/stencil
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -423,7 +423,8 @@ INLINE void UpdateClientStats(SWR_CONTEXT* pContext, uint32_t workerId, DRAW_CON
         stats.DepthPassCount += dynState.pStats[i].DepthPassCount;
         stats.PsInvocations += dynState.pStats[i].PsInvocations;
         stats.CsInvocations += dynState.pStats[i].CsInvocations;
-
+        stats.BackendTiles += dynState.pStats[i].BackendTiles;
+        stats.EarlyZRejects += dynState.pStats[i].EarlyZRejects;
     }
 
 
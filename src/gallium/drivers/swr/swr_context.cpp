@@ -403,6 +403,8 @@ swr_destroy(struct pipe_context *pipe)
 
    delete ctx->blendJIT;
 
+   swr_query_stats_reference(&ctx->query_stats, NULL);
+
    swr_destroy_scratch_buffers(ctx);
 
 
@@ -433,7 +435,7 @@ swr_UpdateStats(HANDLE hPrivateContext, const SWR_STATS *pStats)
 {
    swr_draw_context *pDC = (swr_draw_context*)hPrivateContext;
 
-   if (!pDC)
+   if (!pDC || !pDC->pStats)
       return;
 
    struct swr_query_result *pqr = pDC->pStats;
@@ -443,6 +445,8 @@ swr_UpdateStats(HANDLE hPrivateContext, const SWR_STATS *pStats)
    pSwrStats->DepthPassCount += pStats->DepthPassCount;
    pSwrStats->PsInvocations += pStats->PsInvocations;
    pSwrStats->CsInvocations += pStats->CsInvocations;
+   pSwrStats->BackendTiles += pStats->BackendTiles;
+   pSwrStats->EarlyZRejects += pStats->EarlyZRejects;
 }
 
 static void
@@ -450,7 +454,7 @@ swr_UpdateStatsFE(HANDLE hPrivateContext, const SWR_STATS_FE *pStats)
 {
    swr_draw_context *pDC = (swr_draw_context*)hPrivateContext;
 
-   if (!pDC)
+   if (!pDC || !pDC->pStats)
       return;
 
    struct swr_query_result *pqr = pDC->pStats;
@@ -28,6 +28,7 @@
 
 #include "pipe/p_context.h"
 #include "pipe/p_state.h"
+#include "util/list.h"
 #include "util/u_blitter.h"
 #include "rasterizer/memory/SurfaceState.h"
 #include "rasterizer/memory/InitMemory.h"
@@ -171,6 +172,8 @@ struct swr_context {
    enum pipe_render_cond_flag render_cond_mode;
    bool render_cond_cond;
    unsigned active_queries;
+   struct list_head active_query_list; /* active counter queries */
+   struct swr_query_stats *query_stats; /* block written by new draws */
 
    unsigned num_vertex_buffers;
    unsigned num_samplers[PIPE_SHADER_TYPES];
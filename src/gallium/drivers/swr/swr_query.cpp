@@ -42,7 +42,8 @@ swr_create_query(struct pipe_context *pipe, unsigned type, unsigned index)
 {
    struct swr_query *pq;
 
-   assert(type < PIPE_QUERY_TYPES);
+   assert(type < PIPE_QUERY_TYPES ||
+          (type >= PIPE_QUERY_DRIVER_SPECIFIC && type < SWR_QUERY_LAST));
    assert(index < MAX_SO_STREAMS);
 
    pq = (struct swr_query *) AlignedMalloc(sizeof(struct swr_query), 64);
@@ -51,27 +52,105 @@ swr_create_query(struct pipe_context *pipe, unsigned type, unsigned index)
       memset(pq, 0, sizeof(*pq));
       pq->type = type;
       pq->index = index;
+      util_dynarray_init(&pq->stats, NULL);
    }
 
    return (struct pipe_query *)pq;
 }
 
 
+void
+swr_query_stats_reference(struct swr_query_stats **dst,
+                          struct swr_query_stats *src)
+{
+   if (pipe_reference(*dst ? &(*dst)->reference : NULL,
+                      src ? &src->reference : NULL))
+      AlignedFree(*dst);
+   *dst = src;
+}
+
+static void
+swr_query_release_stats(struct swr_query *pq)
+{
+   util_dynarray_foreach(&pq->stats, struct swr_query_stats *, stats)
+      swr_query_stats_reference(stats, NULL);
+   util_dynarray_clear(&pq->stats);
+}
+
+/* Start a new statistics block for the draws that follow, shared by all
+ * active counter queries.  Draws already queued keep writing to the block
+ * captured in their draw context.
+ */
+static void
+swr_query_switch_stats(struct swr_context *ctx)
+{
+   if (list_is_empty(&ctx->active_query_list))
+      return;
+
+   struct swr_query_stats *stats = (struct swr_query_stats *)
+      AlignedMalloc(sizeof(struct swr_query_stats), 64);
+   memset(stats, 0, sizeof(*stats));
+   pipe_reference_init(&stats->reference, 1);
+
+   list_for_each_entry(struct swr_query, pq, &ctx->active_query_list, active) {
+      struct swr_query_stats *ref = NULL;
+      swr_query_stats_reference(&ref, stats);
+      util_dynarray_append(&pq->stats, struct swr_query_stats *, ref);
+   }
+
+   /* The context owns the initial reference. */
+   swr_query_stats_reference(&ctx->query_stats, NULL);
+   ctx->query_stats = stats;
+   swr_update_draw_context(ctx, &stats->result);
+}
+
+
 static void
 swr_destroy_query(struct pipe_context *pipe, struct pipe_query *q)
 {
    struct swr_query *pq = swr_query(q);
 
+   /* Queued draws may still write to the statistics blocks. */
+   if (pq->is_active)
+      pipe->end_query(pipe, q);
+
    if (pq->fence) {
       if (swr_is_fence_pending(pq->fence))
          swr_fence_finish(pipe->screen, NULL, pq->fence, 0);
       swr_fence_reference(pipe->screen, &pq->fence, NULL);
    }
 
+   swr_query_release_stats(pq);
+   util_dynarray_fini(&pq->stats);
    AlignedFree(pq);
 }
 
 
+static void
+swr_query_accumulate(struct swr_query_result *dst,
+                     const struct swr_query_result *src)
+{
+   dst->core.DepthPassCount += src->core.DepthPassCount;
+   dst->core.PsInvocations += src->core.PsInvocations;
+   dst->core.CsInvocations += src->core.CsInvocations;
+   dst->core.BackendTiles += src->core.BackendTiles;
+   dst->core.EarlyZRejects += src->core.EarlyZRejects;
+
+   dst->coreFE.IaVertices += src->coreFE.IaVertices;
+   dst->coreFE.IaPrimitives += src->coreFE.IaPrimitives;
+   dst->coreFE.VsInvocations += src->coreFE.VsInvocations;
+   dst->coreFE.HsInvocations += src->coreFE.HsInvocations;
+   dst->coreFE.DsInvocations += src->coreFE.DsInvocations;
+   dst->coreFE.GsInvocations += src->coreFE.GsInvocations;
+   dst->coreFE.GsPrimitives += src->coreFE.GsPrimitives;
+   dst->coreFE.CInvocations += src->coreFE.CInvocations;
+   dst->coreFE.CPrimitives += src->coreFE.CPrimitives;
+   for (unsigned i = 0; i < 4; i++) {
+      dst->coreFE.SoPrimStorageNeeded[i] += src->coreFE.SoPrimStorageNeeded[i];
+      dst->coreFE.SoNumPrimsWritten[i] += src->coreFE.SoNumPrimsWritten[i];
+   }
+}
+
 static bool
 swr_get_query_result(struct pipe_context *pipe,
                      struct pipe_query *q,
@@ -89,8 +168,16 @@ swr_get_query_result(struct pipe_context *pipe,
       swr_fence_reference(pipe->screen, &pq->fence, NULL);
    }
 
-   /* All values are reset to 0 at swr_begin_query, except starting timestamp.
-    * Counters become simply end values.  */
+   /* Counters are the sum of the statistics blocks written while the query
+    * was active.  */
+   if (!pq->is_active) {
+      util_dynarray_foreach(&pq->stats, struct swr_query_stats *, stats) {
+         swr_query_accumulate(&pq->result, &(*stats)->result);
+         swr_query_stats_reference(stats, NULL);
+      }
+      util_dynarray_clear(&pq->stats);
+   }
+
    switch (pq->type) {
    /* Booleans */
    case PIPE_QUERY_OCCLUSION_PREDICATE:
@@ -150,6 +237,13 @@ swr_get_query_result(struct pipe_context *pipe,
       result->b = num_primitives_written > primitives_storage_needed;
    }
       break;
+   /* Driver-specific counters */
+   case SWR_QUERY_BACKEND_TILES:
+      result->u64 = pq->result.core.BackendTiles;
+      break;
+   case SWR_QUERY_EARLY_Z_REJECTS:
+      result->u64 = pq->result.core.EarlyZRejects;
+      break;
    default:
       assert(0 && "Unsupported query");
       break;
@@ -164,6 +258,11 @@ swr_begin_query(struct pipe_context *pipe, struct pipe_query *q)
    struct swr_context *ctx = swr_context(pipe);
    struct swr_query *pq = swr_query(q);
 
+   /* Draws from a previous begin/end pair may still be queued. */
+   if (pq->fence && swr_is_fence_pending(pq->fence))
+      swr_fence_finish(pipe->screen, NULL, pq->fence, 0);
+   swr_query_release_stats(pq);
+
    /* Initialize Results */
    memset(&pq->result, 0, sizeof(pq->result));
    switch (pq->type) {
@@ -175,9 +274,11 @@ swr_begin_query(struct pipe_context *pipe, struct pipe_query *q)
       pq->result.timestamp_start = swr_get_timestamp(pipe->screen);
       break;
    default:
-      /* Core counters required.  Update draw context with location to
-       * store results. */
-      swr_update_draw_context(ctx, &pq->result);
+      /* Core counters required.  Following draws write to a new block
+       * that this query shares with the other active queries. */
+      list_addtail(&pq->active, &ctx->active_query_list);
+      pq->is_active = true;
+      swr_query_switch_stats(ctx);
 
       /* Only change stat collection if there are no active queries */
       if (ctx->active_queries == 0) {
@@ -215,6 +316,11 @@ swr_end_query(struct pipe_context *pipe, struct pipe_query *q)
       }
       swr_fence_submit(ctx, pq->fence);
 
+      /* Following draws must not be counted by this query. */
+      list_del(&pq->active);
+      pq->is_active = false;
+      swr_query_switch_stats(ctx);
+
       /* Only change stat collection if there are no active queries */
       ctx->active_queries--;
       if (ctx->active_queries == 0) {
@@ -256,6 +362,32 @@ swr_set_active_query_state(struct pipe_context *pipe, bool enable)
 {
 }
 
+#define SWR_QUERY_INFO(name, query_type) \
+   { name, query_type, { 0 }, PIPE_DRIVER_QUERY_TYPE_UINT64, \
+     PIPE_DRIVER_QUERY_RESULT_TYPE_AVERAGE, 0, 0 }
+
+static const struct pipe_driver_query_info swr_driver_query_list[] = {
+   SWR_QUERY_INFO("swr-backend-tiles", SWR_QUERY_BACKEND_TILES),
+   SWR_QUERY_INFO("swr-early-z-rejects", SWR_QUERY_EARLY_Z_REJECTS),
+};
+
+#undef SWR_QUERY_INFO
+
+int
+swr_get_driver_query_info(struct pipe_screen *screen,
+                          unsigned index,
+                          struct pipe_driver_query_info *info)
+{
+   if (!info)
+      return ARRAY_SIZE(swr_driver_query_list);
+
+   if (index >= ARRAY_SIZE(swr_driver_query_list))
+      return 0;
+
+   *info = swr_driver_query_list[index];
+   return 1;
+}
+
 void
 swr_query_init(struct pipe_context *pipe)
 {
@@ -269,4 +401,6 @@ swr_query_init(struct pipe_context *pipe)
    pipe->set_active_query_state = swr_set_active_query_state;
 
    ctx->active_queries = 0;
+   list_inithead(&ctx->active_query_list);
+   ctx->query_stats = NULL;
 }
@@ -26,6 +26,18 @@
 
 
 #include <limits.h>
+#include "pipe/p_state.h"
+#include "util/list.h"
+#include "util/u_dynarray.h"
+
+/* Driver-specific queries for backend counters that have no pipeline
+ * statistics equivalent, e.g. for GALLIUM_HUD.
+ */
+enum swr_query_type {
+   SWR_QUERY_BACKEND_TILES = PIPE_QUERY_DRIVER_SPECIFIC,
+   SWR_QUERY_EARLY_Z_REJECTS,
+   SWR_QUERY_LAST
+};
 
 struct swr_query_result {
    SWR_STATS core;
@@ -34,15 +46,37 @@ struct swr_query_result {
    uint64_t timestamp_end;
 };
 
+/* Statistics of the draws issued while one set of counter queries was
+ * active.  A new block is started whenever a counter query begins or ends,
+ * and every query that was active during the block holds a reference, so
+ * each query only accumulates the draws issued between its begin and end.
+ */
+OSALIGNLINE(struct) swr_query_stats {
+   struct pipe_reference reference;
+   struct swr_query_result result;
+};
+
 OSALIGNLINE(struct) swr_query {
    unsigned type; /* PIPE_QUERY_* */
    unsigned index;
 
    struct swr_query_result result;
    struct pipe_fence_handle *fence;
+
+   /* Counter queries only */
+   struct list_head active; /* link in swr_context::active_query_list */
+   bool is_active;
+   struct util_dynarray stats; /* struct swr_query_stats * */
 };
 
+extern void swr_query_stats_reference(struct swr_query_stats **dst,
+                                      struct swr_query_stats *src);
+
 extern void swr_query_init(struct pipe_context *pipe);
 
+extern int swr_get_driver_query_info(struct pipe_screen *screen,
+                                     unsigned index,
+                                     struct pipe_driver_query_info *info);
+
 extern bool swr_check_render_cond(struct pipe_context *pipe);
 #endif
@@ -26,6 +26,7 @@
 #include "swr_screen.h"
 #include "swr_resource.h"
 #include "swr_fence.h"
+#include "swr_query.h"
 #include "gen_knobs.h"
 
 #include "pipe/p_screen.h"
@@ -1123,6 +1124,7 @@ swr_create_screen_internal(struct sw_winsys *winsys)
    screen->base.get_param = swr_get_param;
    screen->base.get_shader_param = swr_get_shader_param;
    screen->base.get_paramf = swr_get_paramf;
+   screen->base.get_driver_query_info = swr_get_driver_query_info;
 
    screen->base.resource_create = swr_resource_create;
    screen->base.resource_destroy = swr_resource_destroy;
@@ -0,0 +1,171 @@
+/* Regression test for deferred fences in u_threaded_context.
+ *
+ * A deferred flush creates a fence that points to the unflushed batch, and
+ * waiting for the fence flushes that batch. The fake driver below follows
+ * radeonsi: the fence is signalled when the driver thread executes the
+ * flush call. The test fills a batch up to the early flush threshold with
+ * an idle driver thread, creates a deferred fence and waits for it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pipe/p_context.h"
+#include "pipe/p_screen.h"
+#include "util/u_inlines.h"
+#include "util/u_memory.h"
+#include "util/u_queue.h"
+#include "util/u_threaded_context.h"
+#include "util/u_upload_mgr.h"
+#include "util/os_time.h"
+
+#define WAIT_TIMEOUT_NS (5 * 1000000000ull)
+
+struct fake_fence {
+   struct pipe_reference reference;
+   struct util_queue_fence ready;
+   struct tc_unflushed_batch_token *tc_token;
+};
+
+static int
+fake_get_param(struct pipe_screen *screen, enum pipe_cap param)
+{
+   return param == PIPE_CAP_MIN_MAP_BUFFER_ALIGNMENT ? 64 : 0;
+}
+
+static void
+fake_fence_reference(struct pipe_screen *screen,
+                     struct pipe_fence_handle **ptr,
+                     struct pipe_fence_handle *fence)
+{
+   struct fake_fence *old = (struct fake_fence *)*ptr;
+   struct fake_fence *new = (struct fake_fence *)fence;
+
+   if (pipe_reference(old ? &old->reference : NULL,
+                      new ? &new->reference : NULL)) {
+      tc_unflushed_batch_token_reference(&old->tc_token, NULL);
+      util_queue_fence_destroy(&old->ready);
+      FREE(old);
+   }
+   *ptr = fence;
+}
+
+static struct fake_fence *
+fake_fence_create(bool signalled)
+{
+   struct fake_fence *f = CALLOC_STRUCT(fake_fence);
+
+   pipe_reference_init(&f->reference, 1);
+   util_queue_fence_init(&f->ready);
+   if (!signalled)
+      util_queue_fence_reset(&f->ready);
+   return f;
+}
+
+static bool
+fake_fence_finish(struct pipe_screen *screen, struct pipe_context *ctx,
+                  struct pipe_fence_handle *fence, uint64_t timeout)
+{
+   struct fake_fence *f = (struct fake_fence *)fence;
+
+   /* Like si_fence_finish: flush the batch the fence is waiting for. */
+   if (ctx && f->tc_token)
+      threaded_context_flush(ctx, f->tc_token, timeout == 0);
+
+   return util_queue_fence_wait_timeout(&f->ready,
+                                        os_time_get_absolute_timeout(timeout));
+}
+
+static struct pipe_fence_handle *
+fake_create_fence(struct pipe_context *pipe,
+                  struct tc_unflushed_batch_token *token)
+{
+   struct fake_fence *f = fake_fence_create(false);
+
+   tc_unflushed_batch_token_reference(&f->tc_token, token);
+   return (struct pipe_fence_handle *)f;
+}
+
+static void
+fake_flush(struct pipe_context *pipe, struct pipe_fence_handle **fence,
+           unsigned flags)
+{
+   if (!fence)
+      return;
+
+   if (*fence)
+      util_queue_fence_signal(&((struct fake_fence *)*fence)->ready);
+   else
+      *fence = (struct pipe_fence_handle *)fake_fence_create(true);
+}
+
+static bool
+fake_begin_query(struct pipe_context *pipe, struct pipe_query *query)
+{
+   return true;
+}
+
+static void
+fake_destroy(struct pipe_context *pipe)
+{
+   u_upload_destroy(pipe->stream_uploader);
+}
+
+int
+main(int argc, char **argv)
+{
+   struct pipe_screen screen = {0};
+   struct pipe_context pipe = {0};
+   struct slab_parent_pool transfer_pool;
+   struct pipe_fence_handle *fence = NULL;
+   struct threaded_context *tc;
+
+   setenv("GALLIUM_THREAD", "1", 1);
+
+   screen.get_param = fake_get_param;
+   screen.fence_reference = fake_fence_reference;
+   screen.fence_finish = fake_fence_finish;
+
+   pipe.screen = &screen;
+   pipe.destroy = fake_destroy;
+   pipe.flush = fake_flush;
+   pipe.begin_query = fake_begin_query;
+   pipe.stream_uploader = u_upload_create_default(&pipe);
+   pipe.const_uploader = pipe.stream_uploader;
+
+   slab_create_parent(&transfer_pool, sizeof(struct threaded_transfer), 16);
+
+   struct pipe_context *ctx =
+      threaded_context_create(&pipe, &transfer_pool, NULL, fake_create_fence,
+                              &tc);
+   if (ctx == &pipe) {
+      printf("threaded context not created\n");
+      return 1;
+   }
+
+   /* Fill the batch up to the early flush threshold. The driver thread
+    * hasn't executed anything, so it is idle.
+    */
+   for (unsigned i = 0; i < TC_EARLY_FLUSH_CALLS; i++)
+      ctx->begin_query(ctx, NULL);
+
+   ctx->flush(ctx, &fence, PIPE_FLUSH_DEFERRED);
+
+   bool pass = fence &&
+               screen.fence_finish(&screen, ctx, fence, WAIT_TIMEOUT_NS);
+
+   printf("deferred fence after a full batch: %s\n",
+          pass ? "signalled" : "timed out");
+
+   /* The batch with the flush call must not be executed after the fence
+    * is released if the test failed, so only clean up on success.
+    */
+   if (pass) {
+      screen.fence_reference(&screen, &fence, NULL);
+      ctx->destroy(ctx);
+      slab_destroy_parent(&transfer_pool);
+   }
+
+   return pass ? 0 : 1;
+}
@@ -95,6 +95,39 @@ buffer_usage_warning(struct gl_context *ctx, GLuint *id, const char *fmt, ...)
 static struct gl_buffer_object DummyBufferObject;
 
 
+/**
+ * Invalidate the min/max index cache entries that overlap the given range
+ * of the buffer. The entries are dropped lazily by the next cache lookup.
+ */
+static void
+invalidate_minmax_cache_range(struct gl_buffer_object *bufObj,
+                              GLintptr offset, GLsizeiptr size)
+{
+   GLintptr end = offset + size;
+
+   if (bufObj->MinMaxCacheDirty) {
+      bufObj->MinMaxCacheDirtyStart = MIN2(bufObj->MinMaxCacheDirtyStart,
+                                           offset);
+      bufObj->MinMaxCacheDirtyEnd = MAX2(bufObj->MinMaxCacheDirtyEnd, end);
+   } else {
+      bufObj->MinMaxCacheDirtyStart = offset;
+      bufObj->MinMaxCacheDirtyEnd = end;
+      bufObj->MinMaxCacheDirty = true;
+   }
+}
+
+
+/**
+ * Invalidate the whole min/max index cache, e.g. when the storage is
+ * reallocated.
+ */
+static void
+invalidate_minmax_cache(struct gl_buffer_object *bufObj)
+{
+   invalidate_minmax_cache_range(bufObj, 0, INTPTR_MAX);
+}
+
+
 /**
  * Return pointer to address of a buffer object target.
  * \param ctx  the GL context
@@ -1813,7 +1846,7 @@ buffer_storage(struct gl_context *ctx, struct gl_buffer_object *bufObj,
 
    bufObj->Written = GL_TRUE;
    bufObj->Immutable = GL_TRUE;
-   bufObj->MinMaxCacheDirty = true;
+   invalidate_minmax_cache(bufObj);
 
    if (memObj) {
       assert(ctx->Driver.BufferDataMem);
@@ -2000,7 +2033,10 @@ _mesa_NamedBufferStorageMemEXT_no_error(GLuint buffer, GLsizeiptr size,
 }
 
 
-static ALWAYS_INLINE void
+/**
+ * Returns false if an error was raised and the storage wasn't allocated.
+ */
+static ALWAYS_INLINE bool
 buffer_data(struct gl_context *ctx, struct gl_buffer_object *bufObj,
             GLenum target, GLsizeiptr size, const GLvoid *data, GLenum usage,
             const char *func, bool no_error)
@@ -2018,7 +2054,7 @@ buffer_data(struct gl_context *ctx, struct gl_buffer_object *bufObj,
    if (!no_error) {
       if (size < 0) {
          _mesa_error(ctx, GL_INVALID_VALUE, "%s(size < 0)", func);
-         return;
+         return false;
       }
 
       switch (usage) {
@@ -2045,12 +2081,12 @@ buffer_data(struct gl_context *ctx, struct gl_buffer_object *bufObj,
       if (!valid_usage) {
          _mesa_error(ctx, GL_INVALID_ENUM, "%s(invalid usage: %s)", func,
                      _mesa_enum_to_string(usage));
-         return;
+         return false;
       }
 
       if (bufObj->Immutable || bufObj->HandleAllocated) {
          _mesa_error(ctx, GL_INVALID_OPERATION, "%s(immutable)", func);
-         return;
+         return false;
       }
    }
 
@@ -2060,7 +2096,7 @@ buffer_data(struct gl_context *ctx, struct gl_buffer_object *bufObj,
    FLUSH_VERTICES(ctx, 0);
 
    bufObj->Written = GL_TRUE;
-   bufObj->MinMaxCacheDirty = true;
+   invalidate_minmax_cache(bufObj);
 
 #ifdef VBO_DEBUG
    printf("glBufferDataARB(%u, sz %ld, from %p, usage 0x%x)\n",
@@ -2090,15 +2126,18 @@ buffer_data(struct gl_context *ctx, struct gl_buffer_object *bufObj,
       } else {
          _mesa_error(ctx, GL_OUT_OF_MEMORY, "%s", func);
       }
+      return false;
    }
+
+   return true;
 }
 
-static void
+static bool
 buffer_data_error(struct gl_context *ctx, struct gl_buffer_object *bufObj,
                   GLenum target, GLsizeiptr size, const GLvoid *data,
                   GLenum usage, const char *func)
 {
-   buffer_data(ctx, bufObj, target, size, data, usage, func, false);
+   return buffer_data(ctx, bufObj, target, size, data, usage, func, false);
 }
 
 static void
@@ -2117,6 +2156,50 @@ _mesa_buffer_data(struct gl_context *ctx, struct gl_buffer_object *bufObj,
    buffer_data_error(ctx, bufObj, target, size, data, usage, func);
 }
 
+/**
+ * glBufferData for glthread when the data is in an upload buffer.  The data
+ * is copied only if the storage was allocated, so that a failed BufferData
+ * doesn't raise a second error for the copy.  Takes the reference to
+ * upload_buffer that glthread passes along with the command.
+ */
+void
+_mesa_buffer_data_from_upload(struct gl_context *ctx, GLuint target_or_name,
+                              GLsizeiptr size, GLenum usage, bool named,
+                              bool ext_dsa,
+                              struct gl_buffer_object *upload_buffer,
+                              unsigned upload_offset)
+{
+   struct gl_buffer_object *bufObj;
+   GLenum target = GL_NONE;
+   const char *func;
+
+   if (named && ext_dsa) {
+      func = "glNamedBufferDataEXT";
+      bufObj = _mesa_lookup_bufferobj(ctx, target_or_name);
+      if (!_mesa_handle_bind_buffer_gen(ctx, target_or_name, &bufObj, func))
+         goto done;
+   } else if (named) {
+      func = "glNamedBufferData";
+      bufObj = _mesa_lookup_bufferobj_err(ctx, target_or_name, func);
+      if (!bufObj)
+         goto done;
+   } else {
+      func = "glBufferData";
+      target = target_or_name;
+      bufObj = get_buffer(ctx, func, target, GL_INVALID_OPERATION);
+      if (!bufObj)
+         goto done;
+   }
+
+   if (buffer_data_error(ctx, bufObj, target, size, NULL, usage, func)) {
+      ctx->Driver.CopyBufferSubData(ctx, upload_buffer, bufObj, upload_offset,
+                                    0, size);
+   }
+
+done:
+   _mesa_reference_buffer_object(ctx, &upload_buffer, NULL);
+}
+
 void GLAPIENTRY
 _mesa_BufferData_no_error(GLenum target, GLsizeiptr size, const GLvoid *data,
                           GLenum usage)
@@ -2249,7 +2332,7 @@ _mesa_buffer_sub_data(struct gl_context *ctx, struct gl_buffer_object *bufObj,
 
    bufObj->NumSubDataCalls++;
    bufObj->Written = GL_TRUE;
-   bufObj->MinMaxCacheDirty = true;
+   invalidate_minmax_cache_range(bufObj, offset, size);
 
    assert(ctx->Driver.BufferSubData);
    ctx->Driver.BufferSubData(ctx, offset, size, data, bufObj);
@@ -2458,7 +2541,7 @@ clear_buffer_sub_data(struct gl_context *ctx, struct gl_buffer_object *bufObj,
    if (size == 0)
       return;
 
-   bufObj->MinMaxCacheDirty = true;
+   invalidate_minmax_cache_range(bufObj, offset, size);
 
    if (data == NULL) {
       /* clear to zeros, per the spec */
@@ -3066,7 +3149,7 @@ copy_buffer_sub_data(struct gl_context *ctx, struct gl_buffer_object *src,
       }
    }
 
-   dst->MinMaxCacheDirty = true;
+   invalidate_minmax_cache_range(dst, writeOffset, size);
 
    ctx->Driver.CopyBufferSubData(ctx, src, dst, readOffset, writeOffset, size);
 }
@@ -3084,7 +3167,7 @@ _mesa_CopyBufferSubData_no_error(GLenum readTarget, GLenum writeTarget,
    struct gl_buffer_object **dst_ptr = get_buffer_target(ctx, writeTarget);
    struct gl_buffer_object *dst = *dst_ptr;
 
-   dst->MinMaxCacheDirty = true;
+   invalidate_minmax_cache_range(dst, writeOffset, size);
    ctx->Driver.CopyBufferSubData(ctx, src, dst, readOffset, writeOffset,
                                  size);
 }
@@ -3145,7 +3228,7 @@ _mesa_CopyNamedBufferSubData_no_error(GLuint readBuffer, GLuint writeBuffer,
    struct gl_buffer_object *src = _mesa_lookup_bufferobj(ctx, readBuffer);
    struct gl_buffer_object *dst = _mesa_lookup_bufferobj(ctx, writeBuffer);
 
-   dst->MinMaxCacheDirty = true;
+   invalidate_minmax_cache_range(dst, writeOffset, size);
    ctx->Driver.CopyBufferSubData(ctx, src, dst, readOffset, writeOffset,
                                  size);
 }
@@ -3205,7 +3288,7 @@ _mesa_InternalBufferSubDataCopyMESA(GLintptr srcBuffer, GLuint srcOffset,
    if (!validate_buffer_sub_data(ctx, dst, dstOffset, size, func))
       goto done; /* the error is already set */
 
-   dst->MinMaxCacheDirty = true;
+   invalidate_minmax_cache_range(dst, dstOffset, size);
    ctx->Driver.CopyBufferSubData(ctx, src, dst, srcOffset, dstOffset, size);
 
 done:
@@ -3379,7 +3462,7 @@ map_buffer_range(struct gl_context *ctx, struct gl_buffer_object *bufObj,
 
    if (access & GL_MAP_WRITE_BIT) {
       bufObj->Written = GL_TRUE;
-      bufObj->MinMaxCacheDirty = true;
+      invalidate_minmax_cache_range(bufObj, offset, length);
    }
 
 #ifdef VBO_DEBUG
@@ -127,6 +127,13 @@ _mesa_buffer_data(struct gl_context *ctx, struct gl_buffer_object *bufObj,
                   GLenum target, GLsizeiptr size, const GLvoid *data,
                   GLenum usage, const char *func);
 
+extern void
+_mesa_buffer_data_from_upload(struct gl_context *ctx, GLuint target_or_name,
+                              GLsizeiptr size, GLenum usage, bool named,
+                              bool ext_dsa,
+                              struct gl_buffer_object *upload_buffer,
+                              unsigned upload_offset);
+
 extern void
 _mesa_buffer_sub_data(struct gl_context *ctx, struct gl_buffer_object *bufObj,
                       GLintptr offset, GLsizeiptr size, const GLvoid *data);
@@ -36,6 +36,8 @@
 #include "main/glthread.h"
 #include "main/glthread_marshal.h"
 #include "main/hash.h"
+#include "util/debug.h"
+#include "util/hash_table.h"
 #include "util/u_atomic.h"
 #include "util/u_thread.h"
 
@@ -92,6 +94,7 @@ _mesa_glthread_init(struct gl_context *ctx)
 
    _mesa_glthread_reset_vao(&glthread->DefaultVAO);
    glthread->CurrentVAO = &glthread->DefaultVAO;
+   _mesa_glthread_reset_unpack(ctx);
 
    ctx->MarshalExec = _mesa_create_marshal_table(ctx);
    if (!ctx->MarshalExec) {
@@ -109,6 +112,12 @@ _mesa_glthread_init(struct gl_context *ctx)
    glthread->enabled = true;
    glthread->stats.queue = &glthread->queue;
 
+   if (env_var_as_boolean("MESA_GLTHREAD_SYNC_STATS", false)) {
+      glthread->sync_stats =
+         _mesa_hash_table_create(NULL, _mesa_hash_string,
+                                 _mesa_key_string_equal);
+   }
+
    glthread->SupportsBufferUploads =
       ctx->Const.BufferCreateMapUnsynchronizedThreadSafe &&
       ctx->Const.AllowMappedBuffersDuringExecution;
@@ -137,6 +146,46 @@ free_vao(GLuint key, void *data, void *userData)
    free(data);
 }
 
+static int
+compare_sync_count(const void *a, const void *b)
+{
+   uintptr_t count_a = (uintptr_t)(*(struct hash_entry **)a)->data;
+   uintptr_t count_b = (uintptr_t)(*(struct hash_entry **)b)->data;
+
+   return count_a < count_b ? 1 : count_a > count_b ? -1 : 0;
+}
+
+/**
+ * Print the number of syncs per reason, most frequent first. Syncs from
+ * _mesa_glthread_finish callers that don't give a reason are only part of
+ * the total.
+ */
+static void
+print_sync_stats(struct glthread_state *glthread)
+{
+   struct hash_table *ht = glthread->sync_stats;
+   struct hash_entry **entries = malloc(ht->entries * sizeof(*entries));
+   unsigned num_entries = 0;
+
+   if (!entries)
+      return;
+
+   hash_table_foreach(ht, entry)
+      entries[num_entries++] = entry;
+
+   qsort(entries, num_entries, sizeof(*entries), compare_sync_count);
+
+   fprintf(stderr, "glthread: %u syncs, %u batches\n",
+           glthread->stats.num_syncs, glthread->stats.num_batches);
+   for (unsigned i = 0; i < num_entries; i++) {
+      fprintf(stderr, "glthread: %8u %s\n",
+              (unsigned)(uintptr_t)entries[i]->data,
+              (const char *)entries[i]->key);
+   }
+
+   free(entries);
+}
+
 void
 _mesa_glthread_destroy(struct gl_context *ctx)
 {
@@ -154,6 +203,12 @@ _mesa_glthread_destroy(struct gl_context *ctx)
    _mesa_HashDeleteAll(glthread->VAOs, free_vao, NULL);
    _mesa_DeleteHashTable(glthread->VAOs);
 
+   if (glthread->sync_stats) {
+      print_sync_stats(glthread);
+      _mesa_hash_table_destroy(glthread->sync_stats, NULL);
+      glthread->sync_stats = NULL;
+   }
+
    ctx->GLThread.enabled = false;
 
    _mesa_glthread_restore_dispatch(ctx, "destroy");
@@ -207,12 +262,14 @@ _mesa_glthread_flush_batch(struct gl_context *ctx)
    }
 
    p_atomic_add(&glthread->stats.num_offloaded_items, next->used);
+   p_atomic_inc(&glthread->stats.num_batches);
 
    util_queue_add_job(&glthread->queue, next, &next->fence,
                       glthread_unmarshal_batch, NULL, 0);
    glthread->last = glthread->next;
    glthread->next = (glthread->next + 1) % MARSHAL_MAX_BATCHES;
    glthread->next_batch = &glthread->batches[glthread->next];
+   glthread->SnapshotBytes = 0;
 }
 
 /**
@@ -220,13 +277,15 @@ _mesa_glthread_flush_batch(struct gl_context *ctx)
  *
  * This can be used by the main thread to synchronize access to the context,
  * since the worker thread will be idle after this.
+ *
+ * Returns whether this counted as a sync.
  */
-void
-_mesa_glthread_finish(struct gl_context *ctx)
+static bool
+glthread_finish(struct gl_context *ctx)
 {
    struct glthread_state *glthread = &ctx->GLThread;
    if (!glthread->enabled)
-      return;
+      return false;
 
    /* If this is called from the worker thread, then we've hit a path that
     * might be called from either the main thread or the worker (such as some
@@ -234,7 +293,7 @@ _mesa_glthread_finish(struct gl_context *ctx)
     * synchronize against ourself.
     */
    if (u_thread_is_self(glthread->queue.threads[0]))
-      return;
+      return false;
 
    struct glthread_batch *last = &glthread->batches[glthread->last];
    struct glthread_batch *next = glthread->next_batch;
@@ -254,6 +313,7 @@ _mesa_glthread_finish(struct gl_context *ctx)
       struct _glapi_table *dispatch = _glapi_get_dispatch();
       glthread_unmarshal_batch(next, 0);
       _glapi_set_dispatch(dispatch);
+      glthread->SnapshotBytes = 0;
 
       /* It's not a sync because we don't enqueue partial batches, but
        * it would be a sync if we did. So count it anyway.
@@ -263,13 +323,31 @@ _mesa_glthread_finish(struct gl_context *ctx)
 
    if (synced)
       p_atomic_inc(&glthread->stats.num_syncs);
+
+   return synced;
+}
+
+void
+_mesa_glthread_finish(struct gl_context *ctx)
+{
+   glthread_finish(ctx);
 }
 
 void
 _mesa_glthread_finish_before(struct gl_context *ctx, const char *func)
 {
-   _mesa_glthread_finish(ctx);
+   struct hash_table *ht = ctx->GLThread.sync_stats;
+
+   if (!glthread_finish(ctx) || !ht)
+      return;
+
+   /* Only the application thread gets here, so no locking is needed. */
+   uint32_t hash = _mesa_hash_string(func);
+   struct hash_entry *entry =
+      _mesa_hash_table_search_pre_hashed(ht, hash, func);
 
-   /* Uncomment this if you want to know where glthread syncs. */
-   /*printf("fallback to sync: %s\n", func);*/
+   if (entry)
+      entry->data = (void *)((uintptr_t)entry->data + 1);
+   else
+      _mesa_hash_table_insert_pre_hashed(ht, hash, func, (void *)1);
 }
@@ -87,6 +87,18 @@ struct glthread_vao {
    } Attrib[VERT_ATTRIB_MAX];
 };
 
+/** Pixel unpack state tracked by glthread independently of Mesa. */
+struct glthread_pixelstore {
+   GLint Alignment;
+   GLint RowLength;
+   GLint SkipPixels;
+   GLint SkipRows;
+   GLint ImageHeight;
+   GLint SkipImages;
+   bool SwapBytes;
+   bool LsbFirst;
+};
+
 /** A single batch of commands queued up for execution. */
 struct glthread_batch
 {
@@ -116,8 +128,11 @@ struct glthread_client_attrib {
    bool PrimitiveRestart;
    bool PrimitiveRestartFixedIndex;
 
-   /** Whether this element of the client attrib stack contains saved state. */
-   bool Valid;
+   struct glthread_pixelstore Unpack;
+   GLuint CurrentPixelUnpackBufferName;
+
+   /** Which groups of state this element of the client attrib stack saved. */
+   GLbitfield Mask;
 };
 
 struct glthread_state
@@ -128,6 +143,11 @@ struct glthread_state
    /** This is sent to the driver for framebuffer overlay / HUD. */
    struct util_queue_monitoring stats;
 
+   /** Number of syncs per _mesa_glthread_finish_before caller, keyed by
+    * the function name. Only allocated with MESA_GLTHREAD_SYNC_STATS=1.
+    */
+   struct hash_table *sync_stats;
+
    /** Whether GLThread is enabled. */
    bool enabled;
 
@@ -175,6 +195,18 @@ struct glthread_state
    /** Currently-bound buffer object IDs. */
    GLuint CurrentArrayBufferName;
    GLuint CurrentDrawIndirectBufferName;
+   GLuint CurrentPixelUnpackBufferName;
+
+   /** Pixel unpack state, used to copy texture data from client memory. */
+   struct glthread_pixelstore Unpack;
+
+   /** Bytes of texture data copied into the batch being filled. */
+   unsigned SnapshotBytes;
+
+   /** Bytes of texture data copied and not freed yet by the worker thread,
+    * updated atomically.
+    */
+   unsigned SnapshotBytesInFlight;
 };
 
 void _mesa_glthread_init(struct gl_context *ctx);
@@ -244,5 +276,8 @@ void _mesa_glthread_PushClientAttrib(struct gl_context *ctx, GLbitfield mask,
                                      bool set_default);
 void _mesa_glthread_PopClientAttrib(struct gl_context *ctx);
 void _mesa_glthread_ClientAttribDefault(struct gl_context *ctx, GLbitfield mask);
+void _mesa_glthread_reset_unpack(struct gl_context *ctx);
+void _mesa_glthread_PixelStorei(struct gl_context *ctx, GLenum pname,
+                                GLint param);
 
 #endif /* _GLTHREAD_H*/
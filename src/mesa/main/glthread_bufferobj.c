@@ -73,6 +73,8 @@ _mesa_glthread_upload(struct gl_context *ctx, const void *data,
    if (unlikely(size > INT_MAX))
       return;
 
+   p_atomic_inc(&glthread->stats.num_uploads);
+
    /* The alignment was chosen arbitrarily. */
    unsigned offset = align(glthread->upload_offset, 8);
 
@@ -189,6 +191,9 @@ _mesa_glthread_BindBuffer(struct gl_context *ctx, GLenum target, GLuint buffer)
    case GL_DRAW_INDIRECT_BUFFER:
       glthread->CurrentDrawIndirectBufferName = buffer;
       break;
+   case GL_PIXEL_UNPACK_BUFFER:
+      glthread->CurrentPixelUnpackBufferName = buffer;
+      break;
    }
 }
 
@@ -210,6 +215,8 @@ _mesa_glthread_DeleteBuffers(struct gl_context *ctx, GLsizei n,
          _mesa_glthread_BindBuffer(ctx, GL_ELEMENT_ARRAY_BUFFER, 0);
       if (id == glthread->CurrentDrawIndirectBufferName)
          _mesa_glthread_BindBuffer(ctx, GL_DRAW_INDIRECT_BUFFER, 0);
+      if (id == glthread->CurrentPixelUnpackBufferName)
+         _mesa_glthread_BindBuffer(ctx, GL_PIXEL_UNPACK_BUFFER, 0);
    }
 }
 
@@ -221,6 +228,8 @@ struct marshal_cmd_BufferData
    GLsizeiptr size;
    GLenum usage;
    const GLvoid *data_external_mem;
+   struct gl_buffer_object *upload_buffer; /* If set, data is in this buffer */
+   unsigned upload_offset;
    bool data_null; /* If set, no data follows for "data" */
    bool named;
    bool ext_dsa;
@@ -236,6 +245,13 @@ _mesa_unmarshal_BufferData(struct gl_context *ctx,
    const GLenum usage = cmd->usage;
    const void *data;
 
+   if (cmd->upload_buffer) {
+      _mesa_buffer_data_from_upload(ctx, target_or_name, size, usage,
+                                    cmd->named, cmd->ext_dsa,
+                                    cmd->upload_buffer, cmd->upload_offset);
+      return;
+   }
+
    if (cmd->data_null)
       data = NULL;
    else if (!cmd->named && target_or_name == GL_EXTERNAL_VIRTUAL_MEMORY_BUFFER_AMD)
@@ -280,6 +296,38 @@ _mesa_marshal_BufferData_merged(GLuint target_or_name, GLsizeiptr size,
    bool copy_data = data && !external_mem;
    int cmd_size = sizeof(struct marshal_cmd_BufferData) + (copy_data ? size : 0);
 
+   /* If the data doesn't fit into a batch, put it into an upload buffer
+    * instead of syncing. The storage is allocated and the data copied by
+    * the same command, so nothing is copied if the allocation fails.
+    */
+   if (copy_data && ctx->GLThread.SupportsBufferUploads &&
+       size > 0 && size <= INT_MAX &&
+       (cmd_size < 0 || cmd_size > MARSHAL_MAX_CMD_SIZE) &&
+       !(named && target_or_name == 0)) {
+      struct gl_buffer_object *upload_buffer = NULL;
+      unsigned upload_offset = 0;
+
+      _mesa_glthread_upload(ctx, data, size, &upload_offset, &upload_buffer,
+                            NULL);
+
+      if (upload_buffer) {
+         struct marshal_cmd_BufferData *cmd =
+            _mesa_glthread_allocate_command(ctx, DISPATCH_CMD_BufferData,
+                                            sizeof(*cmd));
+
+         cmd->target_or_name = target_or_name;
+         cmd->size = size;
+         cmd->usage = usage;
+         cmd->data_external_mem = NULL;
+         cmd->upload_buffer = upload_buffer;
+         cmd->upload_offset = upload_offset;
+         cmd->data_null = true;
+         cmd->named = named;
+         cmd->ext_dsa = ext_dsa;
+         return;
+      }
+   }
+
    if (unlikely(size < 0 || size > INT_MAX || cmd_size < 0 ||
                 cmd_size > MARSHAL_MAX_CMD_SIZE ||
                 (named && target_or_name == 0))) {
@@ -305,6 +353,7 @@ _mesa_marshal_BufferData_merged(GLuint target_or_name, GLsizeiptr size,
    cmd->named = named;
    cmd->ext_dsa = ext_dsa;
    cmd->data_external_mem = data;
+   cmd->upload_buffer = NULL;
 
    if (copy_data) {
       char *variable_data = (char *) (cmd + 1);
@@ -398,9 +447,13 @@ _mesa_marshal_BufferSubData_merged(GLuint target_or_name, GLintptr offset,
    /* TODO: Handle offset == 0 && size < buffer_size.
     *       If offset == 0 and size == buffer_size, it's better to discard
     *       the buffer storage, but we don't know the buffer size in glthread.
+    *
+    * Data that doesn't fit into a batch is always uploaded, because
+    * the only alternative is to sync.
     */
    if (ctx->GLThread.SupportsBufferUploads &&
-       data && offset > 0 && size > 0) {
+       data && size > 0 &&
+       (offset > 0 || cmd_size > MARSHAL_MAX_CMD_SIZE)) {
       struct gl_buffer_object *upload_buffer = NULL;
       unsigned upload_offset = 0;
 
@@ -0,0 +1,524 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* This implements texture uploads from client memory for glthread.
+ *
+ * glTexImage and glTexSubImage used to sync because the pixels can be
+ * modified by the application as soon as the call returns. Instead, the app
+ * thread copies the pixels into a tightly packed image, the same way display
+ * lists do, and the conversion and upload are done by the glthread worker.
+ * Later commands that sample or read the texture are executed after the
+ * upload, so they don't need any extra synchronization.
+ *
+ * Copying requires the unpack state, so glthread tracks pixel store state
+ * and the pixel unpack buffer binding. Uploads from a PBO still sync.
+ */
+
+#include "main/glthread_marshal.h"
+#include "main/dispatch.h"
+#include "main/glformats.h"
+#include "main/pack.h"
+#include "main/teximage.h"
+#include "util/u_atomic.h"
+
+/* The total size of the copies that haven't been freed by the worker thread
+ * yet, across all batches. An upload that would exceed it is executed
+ * synchronously instead. A batch is flushed when its copies exceed a quarter
+ * of this, so that the worker can start freeing them early.
+ */
+#define MARSHAL_MAX_SNAPSHOT_SIZE (64 * 1024 * 1024)
+
+void
+_mesa_glthread_reset_unpack(struct gl_context *ctx)
+{
+   struct glthread_state *glthread = &ctx->GLThread;
+
+   memset(&glthread->Unpack, 0, sizeof(glthread->Unpack));
+   glthread->Unpack.Alignment = 4;
+   glthread->CurrentPixelUnpackBufferName = 0;
+}
+
+/* Only values accepted by _mesa_PixelStorei are recorded. Otherwise, the copy
+ * would read different memory than the driver.
+ */
+void
+_mesa_glthread_PixelStorei(struct gl_context *ctx, GLenum pname, GLint param)
+{
+   struct glthread_pixelstore *unpack = &ctx->GLThread.Unpack;
+
+   switch (pname) {
+   case GL_UNPACK_SWAP_BYTES:
+      if (_mesa_is_desktop_gl(ctx))
+         unpack->SwapBytes = param != 0;
+      break;
+   case GL_UNPACK_LSB_FIRST:
+      if (_mesa_is_desktop_gl(ctx))
+         unpack->LsbFirst = param != 0;
+      break;
+   case GL_UNPACK_ROW_LENGTH:
+      if (ctx->API != API_OPENGLES && param >= 0)
+         unpack->RowLength = param;
+      break;
+   case GL_UNPACK_SKIP_PIXELS:
+      if (ctx->API != API_OPENGLES && param >= 0)
+         unpack->SkipPixels = param;
+      break;
+   case GL_UNPACK_SKIP_ROWS:
+      if (ctx->API != API_OPENGLES && param >= 0)
+         unpack->SkipRows = param;
+      break;
+   case GL_UNPACK_IMAGE_HEIGHT:
+      if ((_mesa_is_desktop_gl(ctx) || _mesa_is_gles3(ctx)) && param >= 0)
+         unpack->ImageHeight = param;
+      break;
+   case GL_UNPACK_SKIP_IMAGES:
+      if ((_mesa_is_desktop_gl(ctx) || _mesa_is_gles3(ctx)) && param >= 0)
+         unpack->SkipImages = param;
+      break;
+   case GL_UNPACK_ALIGNMENT:
+      if (param == 1 || param == 2 || param == 4 || param == 8)
+         unpack->Alignment = param;
+      break;
+   }
+}
+
+/**
+ * Whether a TexImage or TexSubImage call is valid as far as its client
+ * memory read is concerned. This only uses state that doesn't change after
+ * context creation. The remaining checks depend on the texture object and
+ * are done by the driver when the copy is executed.
+ *
+ * internalformat is 0 for TexSubImage.
+ */
+static bool
+is_valid_client_image(struct gl_context *ctx, GLuint dims, GLenum target,
+                      GLint level, GLint internalformat, GLsizei width,
+                      GLsizei height, GLsizei depth, GLint border,
+                      GLenum format, GLenum type)
+{
+   if (width <= 0 || height <= 0 || depth <= 0 || border != 0)
+      return false;
+
+   /* Proxy targets don't read client memory. */
+   if (_mesa_is_proxy_texture(target) ||
+       !_mesa_legal_texsubimage_target(ctx, dims, target, false))
+      return false;
+
+   if (level < 0 || level >= _mesa_max_texture_levels(ctx, target))
+      return false;
+
+   if (!_mesa_legal_texture_dimensions(ctx, target, level, width, height,
+                                       depth, border))
+      return false;
+
+   if (_mesa_error_check_format_and_type(ctx, format, type) != GL_NO_ERROR)
+      return false;
+
+   /* GLES also requires format and type to match the internal format. */
+   if (_mesa_is_gles(ctx) && internalformat &&
+       _mesa_gles_error_check_format_and_type(ctx, format, type,
+                                              internalformat) != GL_NO_ERROR)
+      return false;
+
+   return true;
+}
+
+/**
+ * Copy the image that a TexImage or TexSubImage call would read from client
+ * memory. The copy is tightly packed and has to be used with
+ * ctx->DefaultPacking. Its size is returned in *out_size. It must be passed
+ * to account_snapshot once the command is allocated and to free_snapshot
+ * when it's done.
+ *
+ * Return NULL if the call must be executed synchronously instead, which
+ * includes calls with parameters that aren't clearly valid, so that the
+ * driver reports the error without anything being read.
+ */
+static void *
+snapshot_image(struct gl_context *ctx, GLuint dims, GLenum target,
+               GLint level, GLint internalformat, GLsizei width,
+               GLsizei height, GLsizei depth, GLint border, GLenum format,
+               GLenum type, const GLvoid *pixels, unsigned *out_size)
+{
+   struct glthread_state *glthread = &ctx->GLThread;
+
+   /* Bitmaps are rare and need bit shifting for SkipPixels. */
+   if (glthread->CurrentPixelUnpackBufferName || type == GL_BITMAP)
+      return NULL;
+
+   if (!is_valid_client_image(ctx, dims, target, level, internalformat,
+                              width, height, depth, border, format, type))
+      return NULL;
+
+   int bytes_per_pixel = _mesa_bytes_per_pixel(format, type);
+   if (bytes_per_pixel <= 0)
+      return NULL;
+
+   uint64_t size = (uint64_t)bytes_per_pixel * width * height * depth;
+   if (size + p_atomic_read(&glthread->SnapshotBytesInFlight) >
+       MARSHAL_MAX_SNAPSHOT_SIZE)
+      return NULL;
+
+   struct gl_pixelstore_attrib unpack;
+   memset(&unpack, 0, sizeof(unpack));
+   unpack.Alignment = glthread->Unpack.Alignment;
+   unpack.RowLength = glthread->Unpack.RowLength;
+   unpack.SkipPixels = glthread->Unpack.SkipPixels;
+   unpack.SkipRows = glthread->Unpack.SkipRows;
+   unpack.ImageHeight = glthread->Unpack.ImageHeight;
+   unpack.SkipImages = glthread->Unpack.SkipImages;
+   unpack.SwapBytes = glthread->Unpack.SwapBytes;
+   unpack.LsbFirst = glthread->Unpack.LsbFirst;
+
+   void *image = _mesa_unpack_image(dims, width, height, depth, format, type,
+                                    pixels, &unpack);
+   if (image)
+      *out_size = size;
+
+   return image;
+}
+
+/* Called after _mesa_glthread_allocate_command, which resets SnapshotBytes
+ * if it flushes.
+ */
+static void
+account_snapshot(struct gl_context *ctx, unsigned size)
+{
+   ctx->GLThread.SnapshotBytes += size;
+   p_atomic_add(&ctx->GLThread.SnapshotBytesInFlight, size);
+}
+
+static void
+free_snapshot(struct gl_context *ctx, const void *image, unsigned size)
+{
+   free((void *)image);
+   p_atomic_add(&ctx->GLThread.SnapshotBytesInFlight, -(int)size);
+}
+
+static void
+flush_if_snapshots_too_big(struct gl_context *ctx)
+{
+   if (ctx->GLThread.SnapshotBytes > MARSHAL_MAX_SNAPSHOT_SIZE / 4)
+      _mesa_glthread_flush_batch(ctx);
+}
+
+
+/* TexImage1D, TexImage2D, TexImage3D: marshalled asynchronously */
+struct marshal_cmd_TexImage3D
+{
+   struct marshal_cmd_base cmd_base;
+   GLenum target;
+   GLint level;
+   GLint internalformat;
+   GLsizei width;
+   GLsizei height;
+   GLsizei depth;
+   GLint border;
+   GLenum format;
+   GLenum type;
+   GLubyte dims;
+   unsigned snapshot_size; /* If nonzero, pixels is a copy owned by us. */
+   const GLvoid *pixels;
+};
+
+static void
+exec_TexImage(struct gl_context *ctx, const struct marshal_cmd_TexImage3D *cmd)
+{
+   switch (cmd->dims) {
+   case 1:
+      CALL_TexImage1D(ctx->CurrentServerDispatch,
+                      (cmd->target, cmd->level, cmd->internalformat,
+                       cmd->width, cmd->border, cmd->format, cmd->type,
+                       cmd->pixels));
+      break;
+   case 2:
+      CALL_TexImage2D(ctx->CurrentServerDispatch,
+                      (cmd->target, cmd->level, cmd->internalformat,
+                       cmd->width, cmd->height, cmd->border, cmd->format,
+                       cmd->type, cmd->pixels));
+      break;
+   default:
+      CALL_TexImage3D(ctx->CurrentServerDispatch,
+                      (cmd->target, cmd->level, cmd->internalformat,
+                       cmd->width, cmd->height, cmd->depth, cmd->border,
+                       cmd->format, cmd->type, cmd->pixels));
+      break;
+   }
+}
+
+void
+_mesa_unmarshal_TexImage3D(struct gl_context *ctx,
+                           const struct marshal_cmd_TexImage3D *cmd)
+{
+   if (cmd->snapshot_size) {
+      const struct gl_pixelstore_attrib save = ctx->Unpack;
+      ctx->Unpack = ctx->DefaultPacking;
+      exec_TexImage(ctx, cmd);
+      ctx->Unpack = save;
+      free_snapshot(ctx, cmd->pixels, cmd->snapshot_size);
+   } else {
+      exec_TexImage(ctx, cmd);
+   }
+}
+
+void
+_mesa_unmarshal_TexImage1D(struct gl_context *ctx,
+                           const struct marshal_cmd_TexImage1D *cmd)
+{
+   unreachable("never used - all TexImage variants use DISPATCH_CMD_TexImage3D");
+}
+
+void
+_mesa_unmarshal_TexImage2D(struct gl_context *ctx,
+                           const struct marshal_cmd_TexImage2D *cmd)
+{
+   unreachable("never used - all TexImage variants use DISPATCH_CMD_TexImage3D");
+}
+
+static void
+_mesa_marshal_TexImage_merged(GLuint dims, GLenum target, GLint level,
+                              GLint internalformat, GLsizei width,
+                              GLsizei height, GLsizei depth, GLint border,
+                              GLenum format, GLenum type,
+                              const GLvoid *pixels, const char *func)
+{
+   GET_CURRENT_CONTEXT(ctx);
+   struct marshal_cmd_TexImage3D tmp;
+   void *image = NULL;
+
+   tmp.target = target;
+   tmp.level = level;
+   tmp.internalformat = internalformat;
+   tmp.width = width;
+   tmp.height = height;
+   tmp.depth = depth;
+   tmp.border = border;
+   tmp.format = format;
+   tmp.type = type;
+   tmp.dims = dims;
+   tmp.snapshot_size = 0;
+   tmp.pixels = pixels;
+
+   /* A NULL pointer doesn't read client memory even if no PBO is bound. */
+   if (pixels) {
+      image = snapshot_image(ctx, dims, target, level, internalformat,
+                             width, height, depth, border, format, type,
+                             pixels, &tmp.snapshot_size);
+      if (!image) {
+         _mesa_glthread_finish_before(ctx, func);
+         exec_TexImage(ctx, &tmp);
+         return;
+      }
+      tmp.pixels = image;
+   }
+
+   struct marshal_cmd_TexImage3D *cmd =
+      _mesa_glthread_allocate_command(ctx, DISPATCH_CMD_TexImage3D,
+                                      sizeof(*cmd));
+   tmp.cmd_base = cmd->cmd_base;
+   *cmd = tmp;
+
+   if (image) {
+      account_snapshot(ctx, tmp.snapshot_size);
+      flush_if_snapshots_too_big(ctx);
+   }
+}
+
+void GLAPIENTRY
+_mesa_marshal_TexImage1D(GLenum target, GLint level, GLint internalformat,
+                         GLsizei width, GLint border, GLenum format,
+                         GLenum type, const GLvoid *pixels)
+{
+   _mesa_marshal_TexImage_merged(1, target, level, internalformat, width, 1, 1,
+                                 border, format, type, pixels, "TexImage1D");
+}
+
+void GLAPIENTRY
+_mesa_marshal_TexImage2D(GLenum target, GLint level, GLint internalformat,
+                         GLsizei width, GLsizei height, GLint border,
+                         GLenum format, GLenum type, const GLvoid *pixels)
+{
+   _mesa_marshal_TexImage_merged(2, target, level, internalformat, width,
+                                 height, 1, border, format, type, pixels,
+                                 "TexImage2D");
+}
+
+void GLAPIENTRY
+_mesa_marshal_TexImage3D(GLenum target, GLint level, GLint internalformat,
+                         GLsizei width, GLsizei height, GLsizei depth,
+                         GLint border, GLenum format, GLenum type,
+                         const GLvoid *pixels)
+{
+   _mesa_marshal_TexImage_merged(3, target, level, internalformat, width,
+                                 height, depth, border, format, type, pixels,
+                                 "TexImage3D");
+}
+
+
+/* TexSubImage1D, TexSubImage2D, TexSubImage3D: marshalled asynchronously */
+struct marshal_cmd_TexSubImage3D
+{
+   struct marshal_cmd_base cmd_base;
+   GLenum target;
+   GLint level;
+   GLint xoffset;
+   GLint yoffset;
+   GLint zoffset;
+   GLsizei width;
+   GLsizei height;
+   GLsizei depth;
+   GLenum format;
+   GLenum type;
+   GLubyte dims;
+   unsigned snapshot_size; /* If nonzero, pixels is a copy owned by us. */
+   const GLvoid *pixels;
+};
+
+static void
+exec_TexSubImage(struct gl_context *ctx,
+                 const struct marshal_cmd_TexSubImage3D *cmd)
+{
+   switch (cmd->dims) {
+   case 1:
+      CALL_TexSubImage1D(ctx->CurrentServerDispatch,
+                         (cmd->target, cmd->level, cmd->xoffset, cmd->width,
+                          cmd->format, cmd->type, cmd->pixels));
+      break;
+   case 2:
+      CALL_TexSubImage2D(ctx->CurrentServerDispatch,
+                         (cmd->target, cmd->level, cmd->xoffset,
+                          cmd->yoffset, cmd->width, cmd->height,
+                          cmd->format, cmd->type, cmd->pixels));
+      break;
+   default:
+      CALL_TexSubImage3D(ctx->CurrentServerDispatch,
+                         (cmd->target, cmd->level, cmd->xoffset,
+                          cmd->yoffset, cmd->zoffset, cmd->width,
+                          cmd->height, cmd->depth, cmd->format, cmd->type,
+                          cmd->pixels));
+      break;
+   }
+}
+
+void
+_mesa_unmarshal_TexSubImage3D(struct gl_context *ctx,
+                              const struct marshal_cmd_TexSubImage3D *cmd)
+{
+   if (cmd->snapshot_size) {
+      const struct gl_pixelstore_attrib save = ctx->Unpack;
+      ctx->Unpack = ctx->DefaultPacking;
+      exec_TexSubImage(ctx, cmd);
+      ctx->Unpack = save;
+      free_snapshot(ctx, cmd->pixels, cmd->snapshot_size);
+   } else {
+      exec_TexSubImage(ctx, cmd);
+   }
+}
+
+void
+_mesa_unmarshal_TexSubImage1D(struct gl_context *ctx,
+                              const struct marshal_cmd_TexSubImage1D *cmd)
+{
+   unreachable("never used - all TexSubImage variants use DISPATCH_CMD_TexSubImage3D");
+}
+
+void
+_mesa_unmarshal_TexSubImage2D(struct gl_context *ctx,
+                              const struct marshal_cmd_TexSubImage2D *cmd)
+{
+   unreachable("never used - all TexSubImage variants use DISPATCH_CMD_TexSubImage3D");
+}
+
+static void
+_mesa_marshal_TexSubImage_merged(GLuint dims, GLenum target, GLint level,
+                                 GLint xoffset, GLint yoffset, GLint zoffset,
+                                 GLsizei width, GLsizei height, GLsizei depth,
+                                 GLenum format, GLenum type,
+                                 const GLvoid *pixels, const char *func)
+{
+   GET_CURRENT_CONTEXT(ctx);
+   struct marshal_cmd_TexSubImage3D tmp;
+
+   tmp.target = target;
+   tmp.level = level;
+   tmp.xoffset = xoffset;
+   tmp.yoffset = yoffset;
+   tmp.zoffset = zoffset;
+   tmp.width = width;
+   tmp.height = height;
+   tmp.depth = depth;
+   tmp.format = format;
+   tmp.type = type;
+   tmp.dims = dims;
+   tmp.snapshot_size = 0;
+   tmp.pixels = pixels;
+
+   void *image = snapshot_image(ctx, dims, target, level, 0, width, height,
+                                depth, 0, format, type, pixels,
+                                &tmp.snapshot_size);
+   if (!image) {
+      _mesa_glthread_finish_before(ctx, func);
+      exec_TexSubImage(ctx, &tmp);
+      return;
+   }
+   tmp.pixels = image;
+
+   struct marshal_cmd_TexSubImage3D *cmd =
+      _mesa_glthread_allocate_command(ctx, DISPATCH_CMD_TexSubImage3D,
+                                      sizeof(*cmd));
+   tmp.cmd_base = cmd->cmd_base;
+   *cmd = tmp;
+
+   account_snapshot(ctx, tmp.snapshot_size);
+   flush_if_snapshots_too_big(ctx);
+}
+
+void GLAPIENTRY
+_mesa_marshal_TexSubImage1D(GLenum target, GLint level, GLint xoffset,
+                            GLsizei width, GLenum format, GLenum type,
+                            const GLvoid *pixels)
+{
+   _mesa_marshal_TexSubImage_merged(1, target, level, xoffset, 0, 0, width, 1,
+                                    1, format, type, pixels, "TexSubImage1D");
+}
+
+void GLAPIENTRY
+_mesa_marshal_TexSubImage2D(GLenum target, GLint level, GLint xoffset,
+                            GLint yoffset, GLsizei width, GLsizei height,
+                            GLenum format, GLenum type, const GLvoid *pixels)
+{
+   _mesa_marshal_TexSubImage_merged(2, target, level, xoffset, yoffset, 0,
+                                    width, height, 1, format, type, pixels,
+                                    "TexSubImage2D");
+}
+
+void GLAPIENTRY
+_mesa_marshal_TexSubImage3D(GLenum target, GLint level, GLint xoffset,
+                            GLint yoffset, GLint zoffset, GLsizei width,
+                            GLsizei height, GLsizei depth, GLenum format,
+                            GLenum type, const GLvoid *pixels)
+{
+   _mesa_marshal_TexSubImage_merged(3, target, level, xoffset, yoffset,
+                                    zoffset, width, height, depth, format,
+                                    type, pixels, "TexSubImage3D");
+}
@@ -573,6 +573,8 @@ _mesa_glthread_PushClientAttrib(struct gl_context *ctx, GLbitfield mask,
    struct glthread_client_attrib *top =
       &glthread->ClientAttribStack[glthread->ClientAttribStackTop];
 
+   top->Mask = mask & (GL_CLIENT_VERTEX_ARRAY_BIT | GL_CLIENT_PIXEL_STORE_BIT);
+
    if (mask & GL_CLIENT_VERTEX_ARRAY_BIT) {
       top->VAO = *glthread->CurrentVAO;
       top->CurrentArrayBufferName = glthread->CurrentArrayBufferName;
@@ -580,9 +582,12 @@ _mesa_glthread_PushClientAttrib(struct gl_context *ctx, GLbitfield mask,
       top->RestartIndex = glthread->RestartIndex;
       top->PrimitiveRestart = glthread->PrimitiveRestart;
       top->PrimitiveRestartFixedIndex = glthread->PrimitiveRestartFixedIndex;
-      top->Valid = true;
-   } else {
-      top->Valid = false;
+   }
+
+   if (mask & GL_CLIENT_PIXEL_STORE_BIT) {
+      top->Unpack = glthread->Unpack;
+      top->CurrentPixelUnpackBufferName =
+         glthread->CurrentPixelUnpackBufferName;
    }
 
    glthread->ClientAttribStackTop++;
@@ -604,7 +609,13 @@ _mesa_glthread_PopClientAttrib(struct gl_context *ctx)
    struct glthread_client_attrib *top =
       &glthread->ClientAttribStack[glthread->ClientAttribStackTop];
 
-   if (!top->Valid)
+   if (top->Mask & GL_CLIENT_PIXEL_STORE_BIT) {
+      glthread->Unpack = top->Unpack;
+      glthread->CurrentPixelUnpackBufferName =
+         top->CurrentPixelUnpackBufferName;
+   }
+
+   if (!(top->Mask & GL_CLIENT_VERTEX_ARRAY_BIT))
       return;
 
    /* Popping a delete VAO is an error. */
@@ -635,6 +646,9 @@ _mesa_glthread_ClientAttribDefault(struct gl_context *ctx, GLbitfield mask)
 {
    struct glthread_state *glthread = &ctx->GLThread;
 
+   if (mask & GL_CLIENT_PIXEL_STORE_BIT)
+      _mesa_glthread_reset_unpack(ctx);
+
    if (!(mask & GL_CLIENT_VERTEX_ARRAY_BIT))
       return;
 
@@ -38,6 +38,7 @@
 #include "glheader.h"
 #include "hash.h"
 #include "util/hash_table.h"
+#include "util/u_atomic.h"
 #include "util/u_memory.h"
 
 
@@ -61,6 +62,7 @@ _mesa_NewHashTable(void)
       }
 
       _mesa_hash_table_set_deleted_key(table->ht, uint_key(DELETED_KEY_VALUE));
+      util_sparse_array_init(&table->dense, sizeof(void *), 256);
       /*
        * Needs to be recursive, since the callback in _mesa_HashWalk()
        * is allowed to call _mesa_HashRemove().
@@ -94,6 +96,7 @@ _mesa_DeleteHashTable(struct _mesa_HashTable *table)
    }
 
    _mesa_hash_table_destroy(table->ht, NULL);
+   util_sparse_array_finish(&table->dense);
 
    mtx_destroy(&table->Mutex);
    free(table);
@@ -101,6 +104,40 @@ _mesa_DeleteHashTable(struct _mesa_HashTable *table)
 
 
 
+/**
+ * Lookup an entry in the direct-indexed array, without locking.
+ * Only valid for keys below HASH_DENSE_KEY_LIMIT.
+ */
+static inline void *
+hash_lookup_dense(struct _mesa_HashTable *table, GLuint key)
+{
+   void **slot = util_sparse_array_get_if_present(&table->dense, key);
+
+   return slot ? p_atomic_read(slot) : NULL;
+}
+
+
+/**
+ * Update the direct-indexed array entry for key.  The mutex must be held.
+ */
+static inline void
+hash_set_dense(struct _mesa_HashTable *table, GLuint key, void *data)
+{
+   void **slot;
+
+   if (key >= HASH_DENSE_KEY_LIMIT)
+      return;
+
+   if (data)
+      slot = util_sparse_array_get(&table->dense, key);
+   else
+      slot = util_sparse_array_get_if_present(&table->dense, key);
+
+   if (slot)
+      p_atomic_set(slot, data);
+}
+
+
 /**
  * Lookup an entry in the hash table, without locking.
  * \sa _mesa_HashLookup
@@ -113,6 +150,9 @@ _mesa_HashLookup_unlocked(struct _mesa_HashTable *table, GLuint key)
    assert(table);
    assert(key);
 
+   if (key < HASH_DENSE_KEY_LIMIT)
+      return hash_lookup_dense(table, key);
+
    if (key == DELETED_KEY_VALUE)
       return table->deleted_key_data;
 
@@ -128,6 +168,8 @@ _mesa_HashLookup_unlocked(struct _mesa_HashTable *table, GLuint key)
 
 /**
  * Lookup an entry in the hash table.
+ *
+ * Keys below HASH_DENSE_KEY_LIMIT are looked up without taking the mutex.
  * 
  * \param table the hash table.
  * \param key the key.
@@ -138,6 +180,13 @@ void *
 _mesa_HashLookup(struct _mesa_HashTable *table, GLuint key)
 {
    void *res;
+
+   assert(table);
+   assert(key);
+
+   if (key < HASH_DENSE_KEY_LIMIT)
+      return hash_lookup_dense(table, key);
+
    _mesa_HashLockMutex(table);
    res = _mesa_HashLookup_unlocked(table, key);
    _mesa_HashUnlockMutex(table);
@@ -175,6 +224,8 @@ _mesa_HashInsert_unlocked(struct _mesa_HashTable *table, GLuint key, void *data)
    if (key > table->MaxKey)
       table->MaxKey = key;
 
+   hash_set_dense(table, key, data);
+
    if (key == DELETED_KEY_VALUE) {
       table->deleted_key_data = data;
    } else {
@@ -245,6 +296,8 @@ _mesa_HashRemove_unlocked(struct _mesa_HashTable *table, GLuint key)
     */
    assert(!table->InDeleteAll);
 
+   hash_set_dense(table, key, NULL);
+
    if (key == DELETED_KEY_VALUE) {
       table->deleted_key_data = NULL;
    } else {
@@ -289,10 +342,12 @@ _mesa_HashDeleteAll(struct _mesa_HashTable *table,
    table->InDeleteAll = GL_TRUE;
    hash_table_foreach(table->ht, entry) {
       callback((uintptr_t)entry->key, entry->data, userData);
+      hash_set_dense(table, (uintptr_t)entry->key, NULL);
       _mesa_hash_table_remove(table->ht, entry);
    }
    if (table->deleted_key_data) {
       callback(DELETED_KEY_VALUE, table->deleted_key_data, userData);
+      hash_set_dense(table, DELETED_KEY_VALUE, NULL);
       table->deleted_key_data = NULL;
    }
    table->InDeleteAll = GL_FALSE;
@@ -37,6 +37,7 @@
 #include "glheader.h"
 
 #include "c11/threads.h"
+#include "util/sparse_array.h"
 
 /**
  * Magic GLuint object name that gets stored outside of the struct hash_table.
@@ -95,11 +96,26 @@ uint_key(GLuint id)
 }
 /** @} */
 
+/**
+ * GL names below this value are mirrored into a direct-indexed array which
+ * _mesa_HashLookup() reads without taking the mutex.  Names handed out by
+ * glGen*() are small and contiguous, so this covers nearly all lookups
+ * while bounding the memory used by applications picking arbitrary names.
+ */
+#define HASH_DENSE_KEY_LIMIT (1 << 20)
+
 /**
  * The hash table data structure.
+ *
+ * Insertions and removals always take the mutex and update both \c ht and
+ * \c dense.  The nodes of the sparse array are never freed before the table
+ * itself, so lock-free readers can't observe freed memory; they only see
+ * either the old or the new object pointer, which is the same guarantee a
+ * locked lookup gives once the mutex is dropped.
  */
 struct _mesa_HashTable {
    struct hash_table *ht;
+   struct util_sparse_array dense;       /**< void * per key < HASH_DENSE_KEY_LIMIT */
    GLuint MaxKey;                        /**< highest key inserted so far */
    mtx_t Mutex;                          /**< mutual exclusion lock */
    GLboolean InDeleteAll;                /**< Debug check */
@@ -1381,6 +1381,9 @@ struct gl_buffer_object
    unsigned MinMaxCacheHitIndices;
    unsigned MinMaxCacheMissIndices;
    bool MinMaxCacheDirty;
+   /** Byte range written since the cache was last validated */
+   GLintptr MinMaxCacheDirtyStart;
+   GLintptr MinMaxCacheDirtyEnd;
 
    bool HandleAllocated; /**< GL_ARB_bindless_texture */
 };
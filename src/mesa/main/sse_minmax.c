@@ -92,3 +92,88 @@ _mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
    *min_index = min_ui;
    *max_index = max_ui;
 }
+
+void
+_mesa_ushort_array_min_max(const unsigned short *us_indices,
+                           unsigned *min_index, unsigned *max_index,
+                           const unsigned count)
+{
+   unsigned max_us = 0;
+   unsigned min_us = ~0U;
+   unsigned i = 0;
+
+   if (count >= 16) {
+      const __m128i ones = _mm_set1_epi32(~0U);
+      __m128i max_us8 = _mm_setzero_si128();
+      __m128i min_us8 = ones;
+      unsigned vec_count = count & ~0x7;
+
+      for (i = 0; i < vec_count; i += 8) {
+         __m128i us_indices8 = _mm_loadu_si128((const __m128i *)&us_indices[i]);
+         max_us8 = _mm_max_epu16(us_indices8, max_us8);
+         min_us8 = _mm_min_epu16(us_indices8, min_us8);
+      }
+
+      /* PHMINPOSUW gives the horizontal minimum. The maximum is the
+       * complement of the minimum of the complemented values.
+       */
+      min_us = _mm_extract_epi16(_mm_minpos_epu16(min_us8), 0);
+      max_us = ~_mm_extract_epi16(_mm_minpos_epu16(_mm_xor_si128(max_us8,
+                                                                 ones)), 0)
+               & 0xffff;
+   }
+
+   for (; i < count; i++) {
+      if (us_indices[i] > max_us)
+         max_us = us_indices[i];
+      if (us_indices[i] < min_us)
+         min_us = us_indices[i];
+   }
+
+   *min_index = min_us;
+   *max_index = max_us;
+}
+
+void
+_mesa_ubyte_array_min_max(const unsigned char *ub_indices,
+                          unsigned *min_index, unsigned *max_index,
+                          const unsigned count)
+{
+   unsigned max_ub = 0;
+   unsigned min_ub = ~0U;
+   unsigned i = 0;
+
+   if (count >= 32) {
+      uint8_t max_arr[16] __attribute__ ((aligned (16)));
+      uint8_t min_arr[16] __attribute__ ((aligned (16)));
+      __m128i max_ub16 = _mm_setzero_si128();
+      __m128i min_ub16 = _mm_set1_epi32(~0U);
+      unsigned vec_count = count & ~0xf;
+
+      for (i = 0; i < vec_count; i += 16) {
+         __m128i ub_indices16 = _mm_loadu_si128((const __m128i *)&ub_indices[i]);
+         max_ub16 = _mm_max_epu8(ub_indices16, max_ub16);
+         min_ub16 = _mm_min_epu8(ub_indices16, min_ub16);
+      }
+
+      _mm_store_si128((__m128i *)max_arr, max_ub16);
+      _mm_store_si128((__m128i *)min_arr, min_ub16);
+
+      for (unsigned j = 0; j < 16; j++) {
+         if (max_arr[j] > max_ub)
+            max_ub = max_arr[j];
+         if (min_arr[j] < min_ub)
+            min_ub = min_arr[j];
+      }
+   }
+
+   for (; i < count; i++) {
+      if (ub_indices[i] > max_ub)
+         max_ub = ub_indices[i];
+      if (ub_indices[i] < min_ub)
+         min_ub = ub_indices[i];
+   }
+
+   *min_index = min_ub;
+   *max_index = max_ub;
+}
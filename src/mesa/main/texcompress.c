@@ -42,6 +42,8 @@
 #include "texcompress_s3tc.h"
 #include "texcompress_etc.h"
 #include "texcompress_bptc.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_queue.h"
 
 
 /**
@@ -928,6 +930,30 @@ _mesa_get_compressed_fetch_func(mesa_format format)
 }
 
 
+struct decompress_image_job {
+   compressed_fetch_func fetch;
+   const GLubyte *src;
+   GLint stride;
+   GLuint width;
+   GLfloat *dest;
+};
+
+static void
+decompress_image_rows(void *data, unsigned y, unsigned height)
+{
+   const struct decompress_image_job *job = data;
+   GLfloat *dest = job->dest + (size_t)y * job->width * 4;
+   GLuint i, j;
+
+   for (j = y; j < y + height; j++) {
+      for (i = 0; i < job->width; i++) {
+         job->fetch(job->src, job->stride, i, j, dest);
+         dest += 4;
+      }
+   }
+}
+
+
 /**
  * Decompress a compressed texture image, returning a GL_RGBA/GL_FLOAT image.
  * \param srcRowStride  stride in bytes between rows of blocks in the
@@ -939,7 +965,6 @@ _mesa_decompress_image(mesa_format format, GLuint width, GLuint height,
                        GLfloat *dest)
 {
    compressed_fetch_func fetch;
-   GLuint i, j;
    GLuint bytes, bw, bh;
    GLint stride;
 
@@ -954,10 +979,115 @@ _mesa_decompress_image(mesa_format format, GLuint width, GLuint height,
 
    stride = srcRowStride * bh / bytes;
 
-   for (j = 0; j < height; j++) {
-      for (i = 0; i < width; i++) {
-         fetch(src, stride, i, j, dest);
-         dest += 4;
-      }
+   struct decompress_image_job job = {
+      .fetch = fetch,
+      .src = src,
+      .stride = stride,
+      .width = width,
+      .dest = dest,
+   };
+
+   _mesa_compressed_rows_parallel(width, height, bh,
+                                  decompress_image_rows, &job);
+}
+
+
+/* Each job handles at least this many pixels, so that waking up a worker
+ * is cheap compared to the work it does.
+ */
+#define COMPRESSED_JOB_MIN_PIXELS (64 * 64)
+
+#define COMPRESSED_MAX_THREADS 8
+
+static struct util_queue compressed_queue;
+static once_flag compressed_queue_once = ONCE_FLAG_INIT;
+
+static void
+compressed_queue_init(void)
+{
+   unsigned num_threads;
+
+   util_cpu_detect();
+   num_threads = MIN2(util_cpu_caps.nr_cpus, COMPRESSED_MAX_THREADS);
+
+   /* The calling thread does one share of the work itself. If this fails,
+    * the queue stays uninitialized and everything runs on the calling
+    * thread.
+    */
+   if (num_threads > 1) {
+      util_queue_init(&compressed_queue, "texcompress",
+                      COMPRESSED_MAX_THREADS, num_threads - 1,
+                      UTIL_QUEUE_INIT_RESIZE_IF_FULL);
+   }
+}
+
+struct compressed_rows_job {
+   compressed_rows_func func;
+   void *data;
+   unsigned y, height;
+   struct util_queue_fence fence;
+};
+
+static void
+compressed_rows_execute(void *data, int thread_index)
+{
+   struct compressed_rows_job *job = data;
+
+   job->func(job->data, job->y, job->height);
+}
+
+/**
+ * Encode or decode an image on the texture compression worker threads.
+ *
+ * The image is split into bands of whole block rows, and func is called
+ * once per band, from the calling thread and from the workers.  Returns
+ * when all bands are done.  Small images are handled on the calling thread
+ * with a single call.
+ */
+void
+_mesa_compressed_rows_parallel(unsigned width, unsigned height,
+                               unsigned block_height,
+                               compressed_rows_func func, void *data)
+{
+   struct compressed_rows_job jobs[COMPRESSED_MAX_THREADS];
+   unsigned block_rows = DIV_ROUND_UP(height, block_height);
+   uint64_t pixels = (uint64_t)width * height;
+   unsigned num_jobs = 1;
+   unsigned i, y;
+
+   call_once(&compressed_queue_once, compressed_queue_init);
+
+   if (util_queue_is_initialized(&compressed_queue)) {
+      num_jobs = MIN3(compressed_queue.num_threads + 1, block_rows,
+                      pixels / COMPRESSED_JOB_MIN_PIXELS);
+   }
+
+   if (num_jobs <= 1) {
+      func(data, 0, height);
+      return;
+   }
+
+   for (i = 0, y = 0; i < num_jobs; i++) {
+      unsigned rows = block_rows * (i + 1) / num_jobs -
+                      block_rows * i / num_jobs;
+
+      jobs[i].func = func;
+      jobs[i].data = data;
+      jobs[i].y = y;
+      jobs[i].height = MIN2(rows * block_height, height - y);
+      y += jobs[i].height;
+   }
+
+   for (i = 0; i < num_jobs - 1; i++) {
+      util_queue_fence_init(&jobs[i].fence);
+      util_queue_add_job(&compressed_queue, &jobs[i], &jobs[i].fence,
+                         compressed_rows_execute, NULL, 0);
+   }
+
+   compressed_rows_execute(&jobs[num_jobs - 1], 0);
+
+   for (i = 0; i < num_jobs - 1; i++) {
+      util_queue_fence_wait(&jobs[i].fence);
+      util_queue_fence_destroy(&jobs[i].fence);
    }
 }
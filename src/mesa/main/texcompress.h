@@ -28,6 +28,10 @@
 #include "formats.h"
 #include "glheader.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 struct gl_context;
 
 extern GLenum
@@ -63,4 +67,20 @@ _mesa_decompress_image(mesa_format format, GLuint width, GLuint height,
                        const GLubyte *src, GLint srcRowStride,
                        GLfloat *dest);
 
+
+/**
+ * A function that encodes or decodes the pixel rows [y, y + height) of an
+ * image.  y is a multiple of the block height.
+ */
+typedef void (*compressed_rows_func)(void *data, unsigned y, unsigned height);
+
+extern void
+_mesa_compressed_rows_parallel(unsigned width, unsigned height,
+                               unsigned block_height,
+                               compressed_rows_func func, void *data);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* TEXCOMPRESS_H */
@@ -1814,33 +1814,29 @@ decode_error::type Block::calculate_colour_endpoints_size()
    return decode_error::invalid_colour_endpoints_size;
 }
 
-/**
- * Decode ASTC 2D LDR texture data.
- *
- * \param src_width in pixels
- * \param src_height in pixels
- * \param dst_stride in bytes
- */
-extern "C" void
-_mesa_unpack_astc_2d_ldr(uint8_t *dst_row,
-                         unsigned dst_stride,
-                         const uint8_t *src_row,
-                         unsigned src_stride,
-                         unsigned src_width,
-                         unsigned src_height,
-                         mesa_format format)
-{
-   assert(_mesa_is_format_astc_2d(format));
-   bool srgb = _mesa_is_format_srgb(format);
-
+struct unpack_astc_job {
+   uint8_t *dst_row;
+   unsigned dst_stride;
+   const uint8_t *src_row;
+   unsigned src_stride;
+   unsigned src_width;
    unsigned blk_w, blk_h;
-   _mesa_get_format_block_size(format, &blk_w, &blk_h);
+   bool srgb;
+};
 
+static void
+unpack_astc_rows(void *data, unsigned first_row, unsigned height)
+{
+   const unpack_astc_job *job = (const unpack_astc_job *)data;
+   const unsigned blk_w = job->blk_w, blk_h = job->blk_h;
    const unsigned block_size = 16;
-   unsigned x_blocks = (src_width + blk_w - 1) / blk_w;
-   unsigned y_blocks = (src_height + blk_h - 1) / blk_h;
+   const unsigned src_width = job->src_width;
+   const unsigned x_blocks = (src_width + blk_w - 1) / blk_w;
+   const unsigned y_blocks = (height + blk_h - 1) / blk_h;
+   uint8_t *dst_row = job->dst_row + first_row * job->dst_stride;
+   const uint8_t *src_row = job->src_row + first_row / blk_h * job->src_stride;
 
-   Decoder dec(blk_w, blk_h, 1, srgb, true);
+   Decoder dec(blk_w, blk_h, 1, job->srgb, true);
 
    for (unsigned y = 0; y < y_blocks; ++y) {
       for (unsigned x = 0; x < x_blocks; ++x) {
@@ -1850,12 +1846,12 @@ _mesa_unpack_astc_2d_ldr(uint8_t *dst_row,
          dec.decode(src_row + x * block_size, block_out);
 
          /* This can be smaller with NPOT dimensions. */
-         unsigned dst_blk_w = MIN2(blk_w, src_width  - x*blk_w);
-         unsigned dst_blk_h = MIN2(blk_h, src_height - y*blk_h);
+         unsigned dst_blk_w = MIN2(blk_w, src_width - x*blk_w);
+         unsigned dst_blk_h = MIN2(blk_h, height - y*blk_h);
 
          for (unsigned sub_y = 0; sub_y < dst_blk_h; ++sub_y) {
             for (unsigned sub_x = 0; sub_x < dst_blk_w; ++sub_x) {
-               uint8_t *dst = dst_row + sub_y * dst_stride +
+               uint8_t *dst = dst_row + sub_y * job->dst_stride +
                               (x * blk_w + sub_x) * 4;
                const uint16_t *src = &block_out[(sub_y * blk_w + sub_x) * 4];
 
@@ -1866,7 +1862,38 @@ _mesa_unpack_astc_2d_ldr(uint8_t *dst_row,
             }
          }
       }
-      src_row += src_stride;
-      dst_row += dst_stride * blk_h;
+      src_row += job->src_stride;
+      dst_row += job->dst_stride * blk_h;
    }
 }
+
+/**
+ * Decode ASTC 2D LDR texture data.
+ *
+ * \param src_width in pixels
+ * \param src_height in pixels
+ * \param dst_stride in bytes
+ */
+extern "C" void
+_mesa_unpack_astc_2d_ldr(uint8_t *dst_row,
+                         unsigned dst_stride,
+                         const uint8_t *src_row,
+                         unsigned src_stride,
+                         unsigned src_width,
+                         unsigned src_height,
+                         mesa_format format)
+{
+   assert(_mesa_is_format_astc_2d(format));
+
+   unpack_astc_job job;
+   job.dst_row = dst_row;
+   job.dst_stride = dst_stride;
+   job.src_row = src_row;
+   job.src_stride = src_stride;
+   job.src_width = src_width;
+   job.srgb = _mesa_is_format_srgb(format);
+   _mesa_get_format_block_size(format, &job.blk_w, &job.blk_h);
+
+   _mesa_compressed_rows_parallel(src_width, src_height, job.blk_h,
+                                  unpack_astc_rows, &job);
+}
@@ -122,6 +122,42 @@ _mesa_get_bptc_fetch_func(mesa_format format)
    }
 }
 
+/** Arguments of the BPTC compressors, for _mesa_compressed_rows_parallel() */
+struct compress_bptc_job {
+   int width;
+   const void *src;
+   int src_rowstride;
+   uint8_t *dst;
+   int dst_rowstride;
+   bool is_signed;
+};
+
+static void
+compress_rgba_unorm_rows(void *data, unsigned y, unsigned height)
+{
+   const struct compress_bptc_job *job = data;
+
+   compress_rgba_unorm(job->width, height,
+                       (const uint8_t *)job->src + y * job->src_rowstride,
+                       job->src_rowstride,
+                       job->dst + y / BLOCK_SIZE * job->dst_rowstride,
+                       job->dst_rowstride);
+}
+
+static void
+compress_rgb_float_rows(void *data, unsigned y, unsigned height)
+{
+   const struct compress_bptc_job *job = data;
+
+   compress_rgb_float(job->width, height,
+                      (const float *)((const uint8_t *)job->src +
+                                      y * job->src_rowstride),
+                      job->src_rowstride,
+                      job->dst + y / BLOCK_SIZE * job->dst_rowstride,
+                      job->dst_rowstride,
+                      job->is_signed);
+}
+
 GLboolean
 _mesa_texstore_bptc_rgba_unorm(TEXSTORE_PARAMS)
 {
@@ -161,9 +197,16 @@ _mesa_texstore_bptc_rgba_unorm(TEXSTORE_PARAMS)
                                          srcFormat, srcType);
    }
 
-   compress_rgba_unorm(srcWidth, srcHeight,
-                       pixels, rowstride,
-                       dstSlices[0], dstRowStride);
+   struct compress_bptc_job job = {
+      .width = srcWidth,
+      .src = pixels,
+      .src_rowstride = rowstride,
+      .dst = dstSlices[0],
+      .dst_rowstride = dstRowStride,
+   };
+
+   _mesa_compressed_rows_parallel(srcWidth, srcHeight, BLOCK_SIZE,
+                                  compress_rgba_unorm_rows, &job);
 
    free((void *) tempImage);
 
@@ -206,10 +249,17 @@ texstore_bptc_rgb_float(TEXSTORE_PARAMS,
                                          srcFormat, srcType);
    }
 
-   compress_rgb_float(srcWidth, srcHeight,
-                      pixels, rowstride,
-                      dstSlices[0], dstRowStride,
-                      is_signed);
+   struct compress_bptc_job job = {
+      .width = srcWidth,
+      .src = pixels,
+      .src_rowstride = rowstride,
+      .dst = dstSlices[0],
+      .dst_rowstride = dstRowStride,
+      .is_signed = is_signed,
+   };
+
+   _mesa_compressed_rows_parallel(srcWidth, srcHeight, BLOCK_SIZE,
+                                  compress_rgb_float_rows, &job);
 
    free((void *) tempImage);
 
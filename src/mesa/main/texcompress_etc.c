@@ -115,6 +115,28 @@ _mesa_texstore_etc1_rgb8(UNUSED_TEXSTORE_PARAMS)
 }
 
 
+/** Arguments of an ETC1/ETC2 unpack, for _mesa_compressed_rows_parallel() */
+struct unpack_etc_job {
+   uint8_t *dst_row;
+   unsigned dst_stride;
+   const uint8_t *src_row;
+   unsigned src_stride;
+   unsigned width;
+   mesa_format format;
+   bool bgra;
+};
+
+static void
+unpack_etc1_rows(void *data, unsigned y, unsigned height)
+{
+   const struct unpack_etc_job *job = data;
+
+   etc1_unpack_rgba8888(job->dst_row + y * job->dst_stride, job->dst_stride,
+                        job->src_row + y / 4 * job->src_stride,
+                        job->src_stride, job->width, height);
+}
+
+
 /**
  * Decode texture data in format `MESA_FORMAT_ETC1_RGB8` to
  * `MESA_FORMAT_ABGR8888`.
@@ -142,9 +164,16 @@ _mesa_etc1_unpack_rgba8888(uint8_t *dst_row,
                            unsigned src_width,
                            unsigned src_height)
 {
-   etc1_unpack_rgba8888(dst_row, dst_stride,
-                        src_row, src_stride,
-                        src_width, src_height);
+   struct unpack_etc_job job = {
+      .dst_row = dst_row,
+      .dst_stride = dst_stride,
+      .src_row = src_row,
+      .src_stride = src_stride,
+      .width = src_width,
+   };
+
+   _mesa_compressed_rows_parallel(src_width, src_height, 4,
+                                  unpack_etc1_rows, &job);
 }
 
 static uint8_t
@@ -1191,37 +1220,18 @@ _mesa_texstore_etc2_srgb8_punchthrough_alpha1(UNUSED_TEXSTORE_PARAMS)
 }
 
 
-/**
- * Decode texture data in any one of following formats:
- * `MESA_FORMAT_ETC2_RGB8`
- * `MESA_FORMAT_ETC2_SRGB8`
- * `MESA_FORMAT_ETC2_RGBA8_EAC`
- * `MESA_FORMAT_ETC2_SRGB8_ALPHA8_EAC`
- * `MESA_FORMAT_ETC2_R11_EAC`
- * `MESA_FORMAT_ETC2_RG11_EAC`
- * `MESA_FORMAT_ETC2_SIGNED_R11_EAC`
- * `MESA_FORMAT_ETC2_SIGNED_RG11_EAC`
- * `MESA_FORMAT_ETC2_RGB8_PUNCHTHROUGH_ALPHA1`
- * `MESA_FORMAT_ETC2_SRGB8_PUNCHTHROUGH_ALPHA1`
- *
- * The size of the source data must be a multiple of the ETC2 block size
- * even if the texture image's dimensions are not aligned to 4.
- *
- * \param src_width in pixels
- * \param src_height in pixels
- * \param dst_stride in bytes
- */
-
-void
-_mesa_unpack_etc2_format(uint8_t *dst_row,
-                         unsigned dst_stride,
-                         const uint8_t *src_row,
-                         unsigned src_stride,
-                         unsigned src_width,
-                         unsigned src_height,
-			 mesa_format format,
-			 bool bgra)
+static void
+unpack_etc2_rows(void *data, unsigned y, unsigned src_height)
 {
+   const struct unpack_etc_job *job = data;
+   uint8_t *dst_row = job->dst_row + y * job->dst_stride;
+   const uint8_t *src_row = job->src_row + y / 4 * job->src_stride;
+   unsigned dst_stride = job->dst_stride;
+   unsigned src_stride = job->src_stride;
+   unsigned src_width = job->width;
+   mesa_format format = job->format;
+   bool bgra = job->bgra;
+
    if (format == MESA_FORMAT_ETC2_RGB8)
       etc2_unpack_rgb8(dst_row, dst_stride,
                        src_row, src_stride,
@@ -1264,6 +1274,51 @@ _mesa_unpack_etc2_format(uint8_t *dst_row,
 					    src_width, src_height, bgra);
 }
 
+/**
+ * Decode texture data in any one of following formats:
+ * `MESA_FORMAT_ETC2_RGB8`
+ * `MESA_FORMAT_ETC2_SRGB8`
+ * `MESA_FORMAT_ETC2_RGBA8_EAC`
+ * `MESA_FORMAT_ETC2_SRGB8_ALPHA8_EAC`
+ * `MESA_FORMAT_ETC2_R11_EAC`
+ * `MESA_FORMAT_ETC2_RG11_EAC`
+ * `MESA_FORMAT_ETC2_SIGNED_R11_EAC`
+ * `MESA_FORMAT_ETC2_SIGNED_RG11_EAC`
+ * `MESA_FORMAT_ETC2_RGB8_PUNCHTHROUGH_ALPHA1`
+ * `MESA_FORMAT_ETC2_SRGB8_PUNCHTHROUGH_ALPHA1`
+ *
+ * The size of the source data must be a multiple of the ETC2 block size
+ * even if the texture image's dimensions are not aligned to 4.
+ *
+ * \param src_width in pixels
+ * \param src_height in pixels
+ * \param dst_stride in bytes
+ */
+
+void
+_mesa_unpack_etc2_format(uint8_t *dst_row,
+                         unsigned dst_stride,
+                         const uint8_t *src_row,
+                         unsigned src_stride,
+                         unsigned src_width,
+                         unsigned src_height,
+			 mesa_format format,
+			 bool bgra)
+{
+   struct unpack_etc_job job = {
+      .dst_row = dst_row,
+      .dst_stride = dst_stride,
+      .src_row = src_row,
+      .src_stride = src_stride,
+      .width = src_width,
+      .format = format,
+      .bgra = bgra,
+   };
+
+   _mesa_compressed_rows_parallel(src_width, src_height, 4,
+                                  unpack_etc2_rows, &job);
+}
+
 
 
 static void
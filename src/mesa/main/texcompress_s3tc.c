@@ -42,6 +42,49 @@
 #include "util/format_srgb.h"
 
 
+/** Arguments of tx_compress_dxtn(), for _mesa_compressed_rows_parallel() */
+struct compress_dxtn_job {
+   GLint srccomps;
+   GLint width;
+   const GLubyte *pixels;
+   GLenum destFormat;
+   GLubyte *dest;
+   GLint dstRowStride;
+};
+
+static void
+compress_dxtn_rows(void *data, unsigned y, unsigned height)
+{
+   const struct compress_dxtn_job *job = data;
+
+   /* The source rows are tightly packed. */
+   tx_compress_dxtn(job->srccomps, job->width, height,
+                    job->pixels + y * job->width * job->srccomps,
+                    job->destFormat, job->dest + y / 4 * job->dstRowStride,
+                    job->dstRowStride);
+}
+
+/**
+ * tx_compress_dxtn() on the texture compression worker threads.
+ */
+static void
+compress_dxtn(GLint srccomps, GLint width, GLint height,
+              const GLubyte *pixels, GLenum destFormat,
+              GLubyte *dest, GLint dstRowStride)
+{
+   struct compress_dxtn_job job = {
+      .srccomps = srccomps,
+      .width = width,
+      .pixels = pixels,
+      .destFormat = destFormat,
+      .dest = dest,
+      .dstRowStride = dstRowStride,
+   };
+
+   _mesa_compressed_rows_parallel(width, height, 4, compress_dxtn_rows, &job);
+}
+
+
 /**
  * Store user's image in rgb_dxt1 format.
  */
@@ -84,9 +127,9 @@ _mesa_texstore_rgb_dxt1(TEXSTORE_PARAMS)
 
    dst = dstSlices[0];
 
-   tx_compress_dxtn(3, srcWidth, srcHeight, pixels,
-                    GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
-                    dst, dstRowStride);
+   compress_dxtn(3, srcWidth, srcHeight, pixels,
+                 GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+                 dst, dstRowStride);
 
    free((void *) tempImage);
 
@@ -140,9 +183,9 @@ _mesa_texstore_rgba_dxt1(TEXSTORE_PARAMS)
 
    dst = dstSlices[0];
 
-   tx_compress_dxtn(4, srcWidth, srcHeight, pixels,
-                    GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,
-                    dst, dstRowStride);
+   compress_dxtn(4, srcWidth, srcHeight, pixels,
+                 GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,
+                 dst, dstRowStride);
 
    free((void*) tempImage);
 
@@ -195,9 +238,9 @@ _mesa_texstore_rgba_dxt3(TEXSTORE_PARAMS)
 
    dst = dstSlices[0];
 
-   tx_compress_dxtn(4, srcWidth, srcHeight, pixels,
-                    GL_COMPRESSED_RGBA_S3TC_DXT3_EXT,
-                    dst, dstRowStride);
+   compress_dxtn(4, srcWidth, srcHeight, pixels,
+                 GL_COMPRESSED_RGBA_S3TC_DXT3_EXT,
+                 dst, dstRowStride);
 
    free((void *) tempImage);
 
@@ -250,9 +293,9 @@ _mesa_texstore_rgba_dxt5(TEXSTORE_PARAMS)
 
    dst = dstSlices[0];
 
-   tx_compress_dxtn(4, srcWidth, srcHeight, pixels,
-                    GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
-                    dst, dstRowStride);
+   compress_dxtn(4, srcWidth, srcHeight, pixels,
+                 GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+                 dst, dstRowStride);
 
    free((void *) tempImage);
 
@@ -1570,11 +1570,12 @@ legal_teximage_target(struct gl_context *ctx, GLuint dims, GLenum target)
  * Check if the given texture target value is legal for a
  * glTexSubImage, glCopyTexSubImage or glCopyTexImage call.
  * The difference compared to legal_teximage_target() above is that
- * proxy targets are not supported.
+ * proxy targets are not supported.  This only depends on the API and
+ * extensions, so glthread uses it as well.
  */
-static GLboolean
-legal_texsubimage_target(struct gl_context *ctx, GLuint dims, GLenum target,
-                         bool dsa)
+GLboolean
+_mesa_legal_texsubimage_target(struct gl_context *ctx, GLuint dims,
+                               GLenum target, bool dsa)
 {
    switch (dims) {
    case 1:
@@ -1619,7 +1620,8 @@ legal_texsubimage_target(struct gl_context *ctx, GLuint dims, GLenum target,
          return GL_FALSE;
       }
    default:
-      _mesa_problem(ctx, "invalid dims=%u in legal_texsubimage_target()",
+      _mesa_problem(ctx,
+                    "invalid dims=%u in _mesa_legal_texsubimage_target()",
                     dims);
       return GL_FALSE;
    }
@@ -2293,7 +2295,7 @@ copytexture_error_check( struct gl_context *ctx, GLuint dimensions,
    GLenum rb_internal_format;
 
    /* check target */
-   if (!legal_texsubimage_target(ctx, dimensions, target, false)) {
+   if (!_mesa_legal_texsubimage_target(ctx, dimensions, target, false)) {
       _mesa_error(ctx, GL_INVALID_ENUM, "glCopyTexImage%uD(target=%s)",
                   dimensions, _mesa_enum_to_string(target));
       return GL_TRUE;
@@ -3611,7 +3613,7 @@ texsubimage_err(struct gl_context *ctx, GLuint dims, GLenum target, GLint level,
    struct gl_texture_image *texImage;
 
    /* check target (proxies not allowed) */
-   if (!legal_texsubimage_target(ctx, dims, target, false)) {
+   if (!_mesa_legal_texsubimage_target(ctx, dims, target, false)) {
       _mesa_error(ctx, GL_INVALID_ENUM, "glTexSubImage%uD(target=%s)",
                   dims, _mesa_enum_to_string(target));
       return;
@@ -3702,7 +3704,7 @@ texturesubimage(struct gl_context *ctx, GLuint dims,
 
    if (!no_error) {
       /* check target (proxies not allowed) */
-      if (!legal_texsubimage_target(ctx, dims, texObj->Target, true)) {
+      if (!_mesa_legal_texsubimage_target(ctx, dims, texObj->Target, true)) {
          _mesa_error(ctx, GL_INVALID_OPERATION, "%s(target=%s)",
                      callerName, _mesa_enum_to_string(texObj->Target));
          return;
@@ -4589,7 +4591,7 @@ _mesa_CopyTexSubImage1D(GLenum target, GLint level,
    /* Check target (proxies not allowed). Target must be checked prior to
     * calling _mesa_get_current_tex_object.
     */
-   if (!legal_texsubimage_target(ctx, 1, target, false)) {
+   if (!_mesa_legal_texsubimage_target(ctx, 1, target, false)) {
       _mesa_error(ctx, GL_INVALID_ENUM, "%s(invalid target %s)", self,
                   _mesa_enum_to_string(target));
       return;
@@ -4616,7 +4618,7 @@ _mesa_CopyTexSubImage2D(GLenum target, GLint level,
    /* Check target (proxies not allowed). Target must be checked prior to
     * calling _mesa_get_current_tex_object.
     */
-   if (!legal_texsubimage_target(ctx, 2, target, false)) {
+   if (!_mesa_legal_texsubimage_target(ctx, 2, target, false)) {
       _mesa_error(ctx, GL_INVALID_ENUM, "%s(invalid target %s)", self,
                   _mesa_enum_to_string(target));
       return;
@@ -4643,7 +4645,7 @@ _mesa_CopyTexSubImage3D(GLenum target, GLint level,
    /* Check target (proxies not allowed). Target must be checked prior to
     * calling _mesa_get_current_tex_object.
     */
-   if (!legal_texsubimage_target(ctx, 3, target, false)) {
+   if (!_mesa_legal_texsubimage_target(ctx, 3, target, false)) {
       _mesa_error(ctx, GL_INVALID_ENUM, "%s(invalid target %s)", self,
                   _mesa_enum_to_string(target));
       return;
@@ -4671,7 +4673,7 @@ _mesa_CopyTextureSubImage1D(GLuint texture, GLint level,
       return;
 
    /* Check target (proxies not allowed). */
-   if (!legal_texsubimage_target(ctx, 1, texObj->Target, true)) {
+   if (!_mesa_legal_texsubimage_target(ctx, 1, texObj->Target, true)) {
       _mesa_error(ctx, GL_INVALID_OPERATION, "%s(invalid target %s)", self,
                   _mesa_enum_to_string(texObj->Target));
       return;
@@ -4696,7 +4698,7 @@ _mesa_CopyTextureSubImage1DEXT(GLuint texture, GLenum target, GLint level,
       return;
 
    /* Check target (proxies not allowed). */
-   if (!legal_texsubimage_target(ctx, 1, texObj->Target, true)) {
+   if (!_mesa_legal_texsubimage_target(ctx, 1, texObj->Target, true)) {
       _mesa_error(ctx, GL_INVALID_OPERATION, "%s(invalid target %s)", self,
                   _mesa_enum_to_string(texObj->Target));
       return;
@@ -4740,7 +4742,7 @@ _mesa_CopyTextureSubImage2D(GLuint texture, GLint level,
       return;
 
    /* Check target (proxies not allowed). */
-   if (!legal_texsubimage_target(ctx, 2, texObj->Target, true)) {
+   if (!_mesa_legal_texsubimage_target(ctx, 2, texObj->Target, true)) {
       _mesa_error(ctx, GL_INVALID_OPERATION, "%s(invalid target %s)", self,
                   _mesa_enum_to_string(texObj->Target));
       return;
@@ -4765,7 +4767,7 @@ _mesa_CopyTextureSubImage2DEXT(GLuint texture, GLenum target, GLint level,
       return;
 
    /* Check target (proxies not allowed). */
-   if (!legal_texsubimage_target(ctx, 2, texObj->Target, true)) {
+   if (!_mesa_legal_texsubimage_target(ctx, 2, texObj->Target, true)) {
       _mesa_error(ctx, GL_INVALID_OPERATION, "%s(invalid target %s)", self,
                   _mesa_enum_to_string(texObj->Target));
       return;
@@ -4809,7 +4811,7 @@ _mesa_CopyTextureSubImage3D(GLuint texture, GLint level,
       return;
 
    /* Check target (proxies not allowed). */
-   if (!legal_texsubimage_target(ctx, 3, texObj->Target, true)) {
+   if (!_mesa_legal_texsubimage_target(ctx, 3, texObj->Target, true)) {
       _mesa_error(ctx, GL_INVALID_OPERATION, "%s(invalid target %s)", self,
                   _mesa_enum_to_string(texObj->Target));
       return;
@@ -4842,7 +4844,7 @@ _mesa_CopyTextureSubImage3DEXT(GLuint texture, GLenum target, GLint level,
       return;
 
    /* Check target (proxies not allowed). */
-   if (!legal_texsubimage_target(ctx, 3, texObj->Target, true)) {
+   if (!_mesa_legal_texsubimage_target(ctx, 3, texObj->Target, true)) {
       _mesa_error(ctx, GL_INVALID_OPERATION, "%s(invalid target %s)", self,
                   _mesa_enum_to_string(texObj->Target));
       return;
@@ -210,6 +210,10 @@ _mesa_legal_texture_dimensions(struct gl_context *ctx, GLenum target,
                                GLint level, GLint width, GLint height,
                                GLint depth, GLint border);
 
+extern GLboolean
+_mesa_legal_texsubimage_target(struct gl_context *ctx, GLuint dims,
+                               GLenum target, bool dsa);
+
 extern mesa_format
 _mesa_validate_texbuffer_format(const struct gl_context *ctx,
                                 GLenum internalFormat);
@@ -34,6 +34,7 @@
 #include "pipe/p_defines.h"
 #include "st_context.h"
 #include "st_atom.h"
+#include "st_debug.h"
 #include "st_program.h"
 #include "st_manager.h"
 #include "st_util.h"
@@ -58,7 +59,11 @@ void st_init_atoms( struct st_context *st )
 
 void st_destroy_atoms( struct st_context *st )
 {
-   /* no-op */
+   if (ST_DEBUG & DEBUG_DRAW) {
+      debug_printf("st: %u of %u draw validations took the fast path\n",
+                   st->num_fast_validations,
+                   st->num_fast_validations + st->num_full_validations);
+   }
 }
 
 
@@ -166,6 +171,60 @@ static void check_attrib_edgeflag(struct st_context *st)
 }
 
 
+/* States that can be updated by st_validate_shader_resources. */
+#define ST_FAST_RENDER_STATES (ST_ALL_SHADER_RESOURCES & \
+                               ST_PIPELINE_RENDER_STATE_MASK)
+
+/**
+ * Draw-time fast path for the common case where only shader resources
+ * (constants, buffers, textures, samplers, images) changed since the last
+ * draw, e.g. one glUniform call per draw. Shaders and edge flags don't
+ * have to be checked in that case, so only the dirty resource atoms are
+ * called.
+ *
+ * Returns false if other states are dirty and st_validate_state must be
+ * used instead.
+ */
+bool st_validate_shader_resources( struct st_context *st )
+{
+   struct gl_context *ctx = st->ctx;
+   uint64_t dirty;
+   uint32_t dirty_lo, dirty_hi;
+
+   /* Edge flag state is derived from vertex arrays and the current edge
+    * flag, which don't always set dirty bits, so compat contexts have to
+    * take the full path.
+    */
+   if (st->gfx_shaders_may_be_dirty || ctx->API == API_OPENGL_COMPAT)
+      return false;
+
+   /* Winsys drawables can be resized or swapped without setting any dirty
+    * bit. This only compares stamps and sets ST_NEW_FB_STATE if they
+    * changed, which sends us to the full path below.
+    */
+   st_manager_validate_framebuffers(st);
+
+   dirty = (st->dirty | (ctx->NewDriverState & st->active_states)) &
+           ST_PIPELINE_RENDER_STATE_MASK;
+   if (dirty & ~ST_FAST_RENDER_STATES)
+      return false;
+
+   ctx->NewDriverState &= ~dirty;
+
+   dirty_lo = dirty;
+   dirty_hi = dirty >> 32;
+
+   while (dirty_lo)
+      update_functions[u_bit_scan(&dirty_lo)](st);
+   while (dirty_hi)
+      update_functions[32 + u_bit_scan(&dirty_hi)](st);
+
+   st->dirty &= ~ST_PIPELINE_RENDER_STATE_MASK;
+   st->num_fast_validations++;
+   return true;
+}
+
+
 /***********************************************************************
  * Update all derived state:
  */
@@ -57,6 +57,7 @@ enum st_pipeline {
 void st_init_atoms( struct st_context *st );
 void st_destroy_atoms( struct st_context *st );
 void st_validate_state( struct st_context *st, enum st_pipeline pipeline );
+bool st_validate_shader_resources( struct st_context *st );
 GLuint st_compare_func_to_pipe(GLenum func);
 
 void
@@ -69,6 +69,8 @@ st_new_program(struct gl_context *ctx, gl_shader_stage stage, GLuint id,
       break;
    }
 
+   simple_mtx_init(&prog->variant_table_lock, mtx_plain);
+
    return _mesa_init_gl_program(&prog->Base, stage, id, is_arb_asm);
 }
 
@@ -88,6 +90,7 @@ st_delete_program(struct gl_context *ctx, struct gl_program *prog)
       free_glsl_to_tgsi_visitor(stp->glsl_to_tgsi);
 
    free(stp->serialized_nir);
+   simple_mtx_destroy(&stp->variant_table_lock);
 
    /* delete base class */
    _mesa_delete_program( ctx, prog );
@@ -237,6 +237,10 @@ struct st_context
 
    unsigned pin_thread_counter; /* for L3 thread pinning on AMD Zen */
 
+   /* Draw-time validation statistics, printed with ST_DEBUG=draw. */
+   unsigned num_fast_validations;
+   unsigned num_full_validations;
+
    /* If true, further analysis of states is required to know if something
     * has changed. Used mainly for shaders.
     */
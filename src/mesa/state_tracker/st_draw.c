@@ -128,7 +128,10 @@ prepare_draw(struct st_context *st, struct gl_context *ctx)
    /* Validate state. */
    if ((st->dirty | ctx->NewDriverState) & ST_PIPELINE_RENDER_STATE_MASK ||
        st->gfx_shaders_may_be_dirty) {
-      st_validate_state(st, ST_PIPELINE_RENDER);
+      if (!st_validate_shader_resources(st)) {
+         st_validate_state(st, ST_PIPELINE_RENDER);
+         st->num_full_validations++;
+      }
    }
 
    struct pipe_context *pipe = st->pipe;
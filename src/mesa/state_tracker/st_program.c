@@ -53,6 +53,7 @@
 #include "tgsi/tgsi_parse.h"
 #include "tgsi/tgsi_ureg.h"
 
+#include "util/hash_table.h"
 #include "util/u_memory.h"
 
 #include "st_debug.h"
@@ -215,9 +216,105 @@ st_set_prog_affected_state_flags(struct gl_program *prog)
 }
 
 
+static uint32_t
+fp_variant_key_hash(const void *key)
+{
+   return _mesa_hash_data(key, sizeof(struct st_fp_variant_key));
+}
+
+static bool
+fp_variant_key_equal(const void *a, const void *b)
+{
+   return memcmp(a, b, sizeof(struct st_fp_variant_key)) == 0;
+}
+
+static uint32_t
+common_variant_key_hash(const void *key)
+{
+   return _mesa_hash_data(key, sizeof(struct st_common_variant_key));
+}
+
+static bool
+common_variant_key_equal(const void *a, const void *b)
+{
+   return memcmp(a, b, sizeof(struct st_common_variant_key)) == 0;
+}
+
+static const void *
+variant_key(const struct st_program *p, struct st_variant *v)
+{
+   if (p->Base.info.stage == MESA_SHADER_FRAGMENT)
+      return &st_fp_variant(v)->key;
+   else
+      return &st_common_variant(v)->key;
+}
+
+/**
+ * Find the variant matching the key. The key is an st_fp_variant_key for
+ * fragment programs and an st_common_variant_key otherwise.
+ *
+ * Programs are shared by all contexts in a share group, so the table is
+ * only accessed, and the variant list only modified, with
+ * variant_table_lock held.
+ */
+static struct st_variant *
+lookup_variant(struct st_program *p, const void *key)
+{
+   struct st_variant *v = NULL;
+
+   simple_mtx_lock(&p->variant_table_lock);
+   if (p->variant_table) {
+      struct hash_entry *entry =
+         _mesa_hash_table_search(p->variant_table, key);
+      if (entry)
+         v = entry->data;
+   }
+   simple_mtx_unlock(&p->variant_table_lock);
+
+   return v;
+}
+
+/**
+ * Add a variant to the linked list and the lookup table.
+ *
+ * If \p after_first is set, the variant goes after the first one in the
+ * list (if any) instead of at the head, so that the head stays a regular
+ * variant for the shader_has_one_variant fast path in st_update_fp.
+ */
+static void
+add_variant(struct st_program *p, struct st_variant *v, bool after_first)
+{
+   simple_mtx_lock(&p->variant_table_lock);
+
+   if (after_first && p->variants) {
+      v->next = p->variants->next;
+      p->variants->next = v;
+   } else {
+      v->next = p->variants;
+      p->variants = v;
+   }
+
+   if (!p->variant_table) {
+      if (p->Base.info.stage == MESA_SHADER_FRAGMENT) {
+         p->variant_table =
+            _mesa_hash_table_create(NULL, fp_variant_key_hash,
+                                    fp_variant_key_equal);
+      } else {
+         p->variant_table =
+            _mesa_hash_table_create(NULL, common_variant_key_hash,
+                                    common_variant_key_equal);
+      }
+   }
+
+   if (p->variant_table)
+      _mesa_hash_table_insert(p->variant_table, variant_key(p, v), v);
+
+   simple_mtx_unlock(&p->variant_table_lock);
+}
+
 /**
  * Delete a shader variant.  Note the caller must unlink the variant from
- * the linked list.
+ * the linked list and the lookup table.
  */
 static void
 delete_variant(struct st_context *st, struct st_variant *v, GLenum target)
@@ -309,20 +406,25 @@ st_release_variants(struct st_context *st, struct st_program *p)
 {
    struct st_variant *v;
 
+   simple_mtx_lock(&p->variant_table_lock);
+   v = p->variants;
+   p->variants = NULL;
+   _mesa_hash_table_destroy(p->variant_table, NULL);
+   p->variant_table = NULL;
+   simple_mtx_unlock(&p->variant_table_lock);
+
    /* If we are releasing shaders, re-bind them, because we don't
     * know which shaders are bound in the driver.
     */
-   if (p->variants)
+   if (v)
       st_unbind_program(st, p);
 
-   for (v = p->variants; v; ) {
+   while (v) {
       struct st_variant *next = v->next;
       delete_variant(st, v, p->Base.Target);
       v = next;
    }
 
-   p->variants = NULL;
-
    if (p->state.tokens) {
       ureg_free_tokens(p->state.tokens);
       p->state.tokens = NULL;
@@ -823,12 +925,7 @@ st_get_vp_variant(struct st_context *st,
    struct st_common_variant *vpv;
 
    /* Search for existing variant */
-   for (vpv = st_common_variant(stp->variants); vpv;
-        vpv = st_common_variant(vpv->base.next)) {
-      if (memcmp(&vpv->key, key, sizeof(*key)) == 0) {
-         break;
-      }
-   }
+   vpv = st_common_variant(lookup_variant(stp, key));
 
    if (!vpv) {
       /* create now */
@@ -844,9 +941,7 @@ st_get_vp_variant(struct st_context *st,
             vpv->vert_attrib_mask |= 1u << attr;
          }
 
-         /* insert into list */
-         vpv->base.next = stp->variants;
-         stp->variants = &vpv->base;
+         add_variant(stp, &vpv->base, false);
       }
    }
 
@@ -1537,12 +1632,7 @@ st_get_fp_variant(struct st_context *st,
    struct st_fp_variant *fpv;
 
    /* Search for existing variant */
-   for (fpv = st_fp_variant(stfp->variants); fpv;
-        fpv = st_fp_variant(fpv->base.next)) {
-      if (memcmp(&fpv->key, key, sizeof(*key)) == 0) {
-         break;
-      }
-   }
+   fpv = st_fp_variant(lookup_variant(stfp, key));
 
    if (!fpv) {
       /* create new */
@@ -1550,25 +1640,13 @@ st_get_fp_variant(struct st_context *st,
       if (fpv) {
          fpv->base.st = key->st;
 
-         if (key->bitmap || key->drawpixels) {
-            /* Regular variants should always come before the
-             * bitmap & drawpixels variants, (unless there
-             * are no regular variants) so that
-             * st_update_fp can take a fast path when
-             * shader_has_one_variant is set.
-             */
-            if (!stfp->variants) {
-               stfp->variants = &fpv->base;
-            } else {
-               /* insert into list after the first one */
-               fpv->base.next = stfp->variants->next;
-               stfp->variants->next = &fpv->base;
-            }
-         } else {
-            /* insert into list */
-            fpv->base.next = stfp->variants;
-            stfp->variants = &fpv->base;
-         }
+         /* Regular variants should always come before the
+          * bitmap & drawpixels variants, (unless there
+          * are no regular variants) so that
+          * st_update_fp can take a fast path when
+          * shader_has_one_variant is set.
+          */
+         add_variant(stfp, &fpv->base, key->bitmap || key->drawpixels);
       }
    }
 
@@ -1777,10 +1855,7 @@ st_get_common_variant(struct st_context *st,
    struct pipe_shader_state state = {0};
 
    /* Search for existing variant */
-   for (v = prog->variants; v; v = v->next) {
-      if (memcmp(&st_common_variant(v)->key, key, sizeof(*key)) == 0)
-         break;
-   }
+   v = lookup_variant(prog, key);
 
    if (!v) {
       /* create new */
@@ -1862,9 +1937,7 @@ st_get_common_variant(struct st_context *st,
          st_common_variant(v)->key = *key;
          v->st = key->st;
 
-         /* insert into list */
-         v->next = prog->variants;
-         prog->variants = v;
+         add_variant(prog, v, false);
       }
    }
 
@@ -1884,26 +1957,36 @@ destroy_program_variants(struct st_context *st, struct gl_program *target)
 
    struct st_program *p = st_program(target);
    struct st_variant *v, **prevPtr = &p->variants;
-   bool unbound = false;
+   struct st_variant *unlinked = NULL;
 
+   /* Unlink from the list and the table together, so that other contexts
+    * in the share group never see one without the other.
+    */
+   simple_mtx_lock(&p->variant_table_lock);
    for (v = p->variants; v; ) {
       struct st_variant *next = v->next;
       if (v->st == st) {
-         if (!unbound) {
-            st_unbind_program(st, p);
-            unbound = true;
-         }
-
-         /* unlink from list */
          *prevPtr = next;
-         /* destroy this variant */
-         delete_variant(st, v, target->Target);
+         if (p->variant_table)
+            _mesa_hash_table_remove_key(p->variant_table, variant_key(p, v));
+         v->next = unlinked;
+         unlinked = v;
       }
       else {
          prevPtr = &v->next;
       }
       v = next;
    }
+   simple_mtx_unlock(&p->variant_table_lock);
+
+   if (unlinked)
+      st_unbind_program(st, p);
+
+   while (unlinked) {
+      struct st_variant *next = unlinked->next;
+      delete_variant(st, unlinked, target->Target);
+      unlinked = next;
+   }
 }
 
 
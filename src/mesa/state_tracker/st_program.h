@@ -39,6 +39,7 @@
 #include "program/program.h"
 #include "pipe/p_state.h"
 #include "tgsi/tgsi_from_mesa.h"
+#include "util/simple_mtx.h"
 #include "st_context.h"
 #include "st_texture.h"
 #include "st_glsl_to_tgsi.h"
@@ -239,6 +240,10 @@ struct st_program
    struct gl_shader_program *shader_program;
 
    struct st_variant *variants;
+
+   /** Variants keyed by their variant key, for fast lookups */
+   struct hash_table *variant_table;
+   simple_mtx_t variant_table_lock;
 };
 
 
@@ -167,6 +167,14 @@ struct vbo_save_context {
 
    GLuint opcode_vertex_list;
 
+   /* The vertex list most recently compiled into the current display list
+    * and the list position right after it.  If nothing else got compiled
+    * in between, the next vertex list may be appended to it.
+    */
+   struct vbo_save_vertex_list *last_node;
+   const union gl_dlist_node *last_node_block;
+   GLuint last_node_pos;
+
    struct vbo_save_copied_vtx copied;
 
    fi_type *current[VBO_ATTRIB_MAX]; /* points into ctx->ListState */
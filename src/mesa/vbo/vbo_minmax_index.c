@@ -134,9 +134,22 @@ vbo_get_minmax_cached(struct gl_buffer_object *bufferObj,
          goto out_disable;
       }
 
-      _mesa_hash_table_clear(bufferObj->MinMaxCache, vbo_minmax_cache_delete_entry);
+      /* Only drop the entries whose index ranges were written to, so that
+       * partial updates of large index buffers keep the rest of the cache.
+       */
+      hash_table_foreach(bufferObj->MinMaxCache, entry) {
+         const struct minmax_cache_key *k = entry->key;
+         GLintptr start = k->offset;
+         GLintptr end = k->offset + (GLintptr)k->count * k->index_size;
+
+         if (start < bufferObj->MinMaxCacheDirtyEnd &&
+             end > bufferObj->MinMaxCacheDirtyStart) {
+            void *data = entry->data;
+            _mesa_hash_table_remove(bufferObj->MinMaxCache, entry);
+            free(data);
+         }
+      }
       bufferObj->MinMaxCacheDirty = false;
-      goto out_invalidate;
    }
 
    key.index_size = index_size;
@@ -151,7 +164,6 @@ vbo_get_minmax_cached(struct gl_buffer_object *bufferObj,
       found = GL_TRUE;
    }
 
-out_invalidate:
    if (found) {
       /* The hit counter saturates so that we don't accidently disable the
        * cache in a long-running program.
@@ -276,10 +288,16 @@ vbo_get_minmax_index_mapped(unsigned count, unsigned index_size,
          }
       }
       else {
-         for (unsigned i = 0; i < count; i++) {
-            if (us_indices[i] > max_us) max_us = us_indices[i];
-            if (us_indices[i] < min_us) min_us = us_indices[i];
+#if defined(USE_SSE41)
+         if (cpu_has_sse4_1) {
+            _mesa_ushort_array_min_max(us_indices, &min_us, &max_us, count);
          }
+         else
+#endif
+            for (unsigned i = 0; i < count; i++) {
+               if (us_indices[i] > max_us) max_us = us_indices[i];
+               if (us_indices[i] < min_us) min_us = us_indices[i];
+            }
       }
       *min_index = min_us;
       *max_index = max_us;
@@ -298,10 +316,16 @@ vbo_get_minmax_index_mapped(unsigned count, unsigned index_size,
          }
       }
       else {
-         for (unsigned i = 0; i < count; i++) {
-            if (ub_indices[i] > max_ub) max_ub = ub_indices[i];
-            if (ub_indices[i] < min_ub) min_ub = ub_indices[i];
+#if defined(USE_SSE41)
+         if (cpu_has_sse4_1) {
+            _mesa_ubyte_array_min_max(ub_indices, &min_ub, &max_ub, count);
          }
+         else
+#endif
+            for (unsigned i = 0; i < count; i++) {
+               if (ub_indices[i] > max_ub) max_ub = ub_indices[i];
+               if (ub_indices[i] < min_ub) min_ub = ub_indices[i];
+            }
       }
       *min_index = min_ub;
       *max_index = max_ub;
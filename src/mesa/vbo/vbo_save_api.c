@@ -462,26 +462,92 @@ update_vao(struct gl_context *ctx,
 
 
 /**
- * Insert the active immediate struct onto the display list currently
- * being built.
+ * Can the vertices being compiled be appended to the previous vertex list
+ * node instead of getting a node of their own?
+ *
+ * This requires that nothing else was compiled into the display list since
+ * that node, that both use the same VAOs (thus the same buffer, offset and
+ * vertex layout) and primitive store, and that no primitive spans the two.
+ * Replaying the merged node then draws both in a single draw call.
+ */
+static bool
+can_append_to_last_node(struct gl_context *ctx)
+{
+   struct vbo_save_context *save = &vbo_context(ctx)->save;
+   const struct vbo_save_vertex_list *last = save->last_node;
+
+   if (!last ||
+       save->last_node_block != ctx->ListState.CurrentBlock ||
+       save->last_node_pos != ctx->ListState.CurrentPos)
+      return false;
+
+   if (last->prim_store != save->prim_store)
+      return false;
+
+   for (gl_vertex_processing_mode vpm = VP_MODE_FF; vpm < VP_MODE_MAX; ++vpm) {
+      if (last->VAO[vpm] != save->VAO[vpm])
+         return false;
+   }
+
+   if (last->prim_count == 0 || last->vertex_count == 0 ||
+       !last->prims[last->prim_count - 1].end)
+      return false;
+
+   if (save->prim_count == 0 || save->vert_count == 0 ||
+       !save->prims[0].begin || save->copied.nr != 0)
+      return false;
+
+   return true;
+}
+
+
+/**
+ * Append the freshly compiled vertex list to the previous node.
+ *
+ * The current values stored with the new list supersede the ones of the
+ * previous list: both have the same set of enabled arrays and those arrays
+ * don't read the current values while drawing.
  */
 static void
-compile_vertex_list(struct gl_context *ctx)
+append_to_last_node(struct gl_context *ctx,
+                    struct vbo_save_vertex_list *node)
 {
    struct vbo_save_context *save = &vbo_context(ctx)->save;
-   struct vbo_save_vertex_list *node;
+   struct vbo_save_vertex_list *last = save->last_node;
 
-   /* Allocate space for this structure in the display list currently
-    * being compiled.
+   /* Both prim arrays live in the same primitive store and the new one
+    * comes after the old one, so this only ever moves prims down.
     */
-   node = (struct vbo_save_vertex_list *)
-      _mesa_dlist_alloc_aligned(ctx, save->opcode_vertex_list, sizeof(*node));
+   assert(last->prims + last->prim_count <= node->prims);
+   memmove(last->prims + last->prim_count, node->prims,
+           node->prim_count * sizeof(struct _mesa_prim));
 
-   if (!node)
-      return;
+   /* Only the prims around the seam can be merged, the rest was already
+    * handled when each list got compiled.
+    */
+   GLuint seam = last->prim_count - 1;
+   GLuint count = node->prim_count + 1;
+   merge_prims(ctx, last->prims + seam, &count);
+   last->prim_count = seam + count;
+   last->vertex_count += node->vertex_count;
+
+   if (node->current_data) {
+      free(last->current_data);
+      last->current_data = node->current_data;
+   }
+}
 
-   /* Make sure the pointer is aligned to the size of a pointer */
-   assert((GLintptr) node % sizeof(void *) == 0);
+
+/**
+ * Insert the active immediate struct onto the display list currently
+ * being built.
+ */
+static void
+compile_vertex_list(struct gl_context *ctx)
+{
+   struct vbo_save_context *save = &vbo_context(ctx)->save;
+   struct vbo_save_vertex_list *node;
+   struct vbo_save_vertex_list appended_node;
 
    /* Duplicate our template, increment refcounts to the storage structs:
     */
@@ -517,11 +583,6 @@ compile_vertex_list(struct gl_context *ctx)
       offsets[i] = offset;
       offset += save->attrsz[i] * sizeof(GLfloat);
    }
-   node->vertex_count = save->vert_count;
-   node->wrap_count = save->copied.nr;
-   node->prims = save->prims;
-   node->prim_count = save->prim_count;
-   node->prim_store = save->prim_store;
 
    /* Create a pair of VAOs for the possible VERTEX_PROCESSING_MODEs
     * Note that this may reuse the previous one of possible.
@@ -531,12 +592,49 @@ compile_vertex_list(struct gl_context *ctx)
       update_vao(ctx, vpm, &save->VAO[vpm],
                  save->vertex_store->bufferobj, buffer_offset, stride,
                  save->enabled, save->attrsz, save->attrtype, offsets);
-      /* Reference the vao in the dlist */
-      node->VAO[vpm] = NULL;
-      _mesa_reference_vao(ctx, &node->VAO[vpm], save->VAO[vpm]);
    }
 
-   node->prim_store->refcount++;
+   const bool append = can_append_to_last_node(ctx);
+
+   if (append) {
+      /* The node only lives until it got appended to the last one, it
+       * doesn't hold any references of its own.
+       */
+      node = &appended_node;
+      memset(node, 0, sizeof(*node));
+      for (gl_vertex_processing_mode vpm = VP_MODE_FF; vpm < VP_MODE_MAX;
+           ++vpm)
+         node->VAO[vpm] = save->VAO[vpm];
+   } else {
+      /* Allocate space for this structure in the display list currently
+       * being compiled.
+       */
+      node = (struct vbo_save_vertex_list *)
+         _mesa_dlist_alloc_aligned(ctx, save->opcode_vertex_list,
+                                   sizeof(*node));
+
+      if (!node)
+         return;
+
+      /* Make sure the pointer is aligned to the size of a pointer */
+      assert((GLintptr) node % sizeof(void *) == 0);
+
+      /* Reference the vaos in the dlist */
+      for (gl_vertex_processing_mode vpm = VP_MODE_FF; vpm < VP_MODE_MAX;
+           ++vpm) {
+         node->VAO[vpm] = NULL;
+         _mesa_reference_vao(ctx, &node->VAO[vpm], save->VAO[vpm]);
+      }
+   }
+
+   node->vertex_count = save->vert_count;
+   node->wrap_count = save->copied.nr;
+   node->prims = save->prims;
+   node->prim_count = save->prim_count;
+   node->prim_store = save->prim_store;
+
+   if (!append)
+      node->prim_store->refcount++;
 
    if (save->no_current_update) {
       node->current_data = NULL;
@@ -603,6 +701,14 @@ compile_vertex_list(struct gl_context *ctx)
       _glapi_set_dispatch(dispatch);
    }
 
+   if (append) {
+      append_to_last_node(ctx, node);
+   } else {
+      save->last_node = node;
+      save->last_node_block = ctx->ListState.CurrentBlock;
+      save->last_node_pos = ctx->ListState.CurrentPos;
+   }
+
    /* Decide whether the storage structs are full, or can be used for
     * the next vertex lists as well.
     */
@@ -1559,6 +1665,7 @@ vbo_save_NewList(struct gl_context *ctx, GLuint list, GLenum mode)
       save->vertex_store = alloc_vertex_store(ctx);
 
    save->buffer_ptr = vbo_save_map_vertex_store(ctx, save->vertex_store);
+   save->last_node = NULL;
 
    reset_vertex(ctx);
    reset_counters(ctx);
@@ -269,7 +269,7 @@ util_format_latc2_snorm_unpack_rgba_float(void *dst_row, unsigned dst_stride, co
       for(x = 0; x < width; x += 4) {
          for(j = 0; j < 4; ++j) {
             for(i = 0; i < 4; ++i) {
-               float *dst = (float *)(uint8_t *)dst_row + (y + j)*dst_stride + (x + i)*16;
+               float *dst = (float *)((uint8_t *)dst_row + (y + j)*dst_stride + (x + i)*16);
                int8_t tmp_r, tmp_g;
                util_format_signed_fetch_texel_rgtc(0, src, i, j, &tmp_r, 2);
                util_format_signed_fetch_texel_rgtc(0, src + 8, i, j, &tmp_g, 2);
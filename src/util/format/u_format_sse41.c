@@ -0,0 +1,316 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <smmintrin.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "util/macros.h"
+#include "u_format_sse41.h"
+
+/* The kernels convert four pixels at a time.  None of the formats has more
+ * than 16 bytes per pixel.
+ */
+#define BLOCK_PIXELS 4
+#define MAX_PIXEL_SIZE 16
+
+typedef void (*block_func)(void *dst, const void *src);
+
+/**
+ * Runs a four pixel kernel over a rectangle.  The pixels that are left at the
+ * end of a row go through temporaries, so that the kernel never touches
+ * memory past the end of the row.
+ */
+static ALWAYS_INLINE void
+convert_rows(uint8_t *dst_row, unsigned dst_stride, unsigned dst_bpp,
+             const uint8_t *src_row, unsigned src_stride, unsigned src_bpp,
+             unsigned width, unsigned height, block_func func)
+{
+   for (unsigned y = 0; y < height; y++) {
+      uint8_t *dst = dst_row;
+      const uint8_t *src = src_row;
+      unsigned x;
+
+      for (x = 0; x + BLOCK_PIXELS <= width; x += BLOCK_PIXELS) {
+         func(dst, src);
+         dst += BLOCK_PIXELS * dst_bpp;
+         src += BLOCK_PIXELS * src_bpp;
+      }
+
+      if (x < width) {
+         uint8_t tmp_src[BLOCK_PIXELS * MAX_PIXEL_SIZE] = { 0 };
+         uint8_t tmp_dst[BLOCK_PIXELS * MAX_PIXEL_SIZE];
+
+         memcpy(tmp_src, src, (width - x) * src_bpp);
+         func(tmp_dst, tmp_src);
+         memcpy(dst, tmp_dst, (width - x) * dst_bpp);
+      }
+
+      dst_row += dst_stride;
+      src_row += src_stride;
+   }
+}
+
+/* Swaps bytes 0 and 2 of each pixel, which converts between RGBA8 and
+ * BGRA8 in either direction.
+ */
+static inline __m128i
+swap_rb_8(__m128i pixels)
+{
+   return _mm_shuffle_epi8(pixels, _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7,
+                                                 10, 9, 8, 11, 14, 13, 12, 15));
+}
+
+/** Same as ubyte_to_float() applied to each byte of four RGBA8 pixels. */
+static ALWAYS_INLINE void
+unorm8_to_float(float *dst, __m128i pixels, bool has_alpha)
+{
+   const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+
+   for (unsigned i = 0; i < BLOCK_PIXELS; i++) {
+      __m128 v = _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(pixels)), scale);
+
+      if (!has_alpha)
+         v = _mm_blend_ps(v, _mm_set1_ps(1.0f), 0x8);
+
+      _mm_storeu_ps(dst + 4 * i, v);
+      pixels = _mm_srli_si128(pixels, 4);
+   }
+}
+
+/** Same as float_to_ubyte(), giving one 32-bit lane per channel. */
+static inline __m128i
+float_to_unorm8(__m128 f)
+{
+   /* The low byte of the float's bits is the rounded result for values in
+    * (0, 1).  NaN and values <= 0 give 0, values >= 1 give 255.
+    */
+   __m128 biased = _mm_add_ps(_mm_mul_ps(f, _mm_set1_ps(255.0f / 256.0f)),
+                              _mm_set1_ps(32768.0f));
+   __m128i v = _mm_and_si128(_mm_castps_si128(biased), _mm_set1_epi32(0xff));
+
+   v = _mm_and_si128(v, _mm_castps_si128(_mm_cmpgt_ps(f, _mm_setzero_ps())));
+   return _mm_blendv_epi8(v, _mm_set1_epi32(0xff),
+                          _mm_castps_si128(_mm_cmpge_ps(f, _mm_set1_ps(1.0f))));
+}
+
+static ALWAYS_INLINE void
+float_to_unorm8_block(void *dst, const float *src, bool swap_rb)
+{
+   __m128i c[BLOCK_PIXELS];
+
+   for (unsigned i = 0; i < BLOCK_PIXELS; i++) {
+      __m128 v = _mm_loadu_ps(src + 4 * i);
+
+      if (swap_rb)
+         v = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 1, 2));
+
+      c[i] = float_to_unorm8(v);
+   }
+
+   _mm_storeu_si128(dst, _mm_packus_epi16(_mm_packus_epi32(c[0], c[1]),
+                                          _mm_packus_epi32(c[2], c[3])));
+}
+
+/** Same as util_half_to_float() on each 32-bit lane. */
+static inline __m128
+half_to_float(__m128i h)
+{
+   __m128i mag = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7fff)), 13);
+   __m128 f = _mm_mul_ps(_mm_castsi128_ps(mag),
+                         _mm_castsi128_ps(_mm_set1_epi32(0xef << 23)));
+   __m128 infnan = _mm_cmpge_ps(f, _mm_set1_ps(65536.0f));
+   __m128i sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+
+   f = _mm_or_ps(f, _mm_and_ps(infnan,
+                               _mm_castsi128_ps(_mm_set1_epi32(0xff << 23))));
+   return _mm_or_ps(f, _mm_castsi128_ps(sign));
+}
+
+static void
+r8g8b8a8_unorm_unpack_rgba_float_block(void *dst, const void *src)
+{
+   unorm8_to_float(dst, _mm_loadu_si128(src), true);
+}
+
+static void
+r8g8b8x8_unorm_unpack_rgba_float_block(void *dst, const void *src)
+{
+   unorm8_to_float(dst, _mm_loadu_si128(src), false);
+}
+
+static void
+b8g8r8a8_unorm_unpack_rgba_float_block(void *dst, const void *src)
+{
+   unorm8_to_float(dst, swap_rb_8(_mm_loadu_si128(src)), true);
+}
+
+static void
+b8g8r8x8_unorm_unpack_rgba_float_block(void *dst, const void *src)
+{
+   unorm8_to_float(dst, swap_rb_8(_mm_loadu_si128(src)), false);
+}
+
+static void
+r8g8b8a8_unorm_pack_rgba_float_block(void *dst, const void *src)
+{
+   float_to_unorm8_block(dst, src, false);
+}
+
+static void
+b8g8r8a8_unorm_pack_rgba_float_block(void *dst, const void *src)
+{
+   float_to_unorm8_block(dst, src, true);
+}
+
+static void
+b8g8r8a8_unorm_swizzle_8unorm_block(void *dst, const void *src)
+{
+   _mm_storeu_si128(dst, swap_rb_8(_mm_loadu_si128(src)));
+}
+
+static void
+b8g8r8x8_unorm_unpack_rgba_8unorm_block(void *dst, const void *src)
+{
+   _mm_storeu_si128(dst, _mm_or_si128(swap_rb_8(_mm_loadu_si128(src)),
+                                      _mm_set1_epi32(0xff000000)));
+}
+
+static void
+r10g10b10a2_unorm_unpack_rgba_float_block(void *dst, const void *src)
+{
+   __m128i v = _mm_loadu_si128(src);
+   __m128i mask = _mm_set1_epi32(0x3ff);
+   __m128 scale = _mm_set1_ps(1.0f / 0x3ff);
+
+   /* One channel of all four pixels per register, then transpose. */
+   __m128 r = _mm_cvtepi32_ps(_mm_and_si128(v, mask));
+   __m128 g = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(v, 10), mask));
+   __m128 b = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(v, 20), mask));
+   __m128 a = _mm_cvtepi32_ps(_mm_srli_epi32(v, 30));
+
+   r = _mm_mul_ps(r, scale);
+   g = _mm_mul_ps(g, scale);
+   b = _mm_mul_ps(b, scale);
+   a = _mm_mul_ps(a, _mm_set1_ps(1.0f / 0x3));
+
+   _MM_TRANSPOSE4_PS(r, g, b, a);
+
+   float *d = dst;
+   _mm_storeu_ps(d + 0, r);
+   _mm_storeu_ps(d + 4, g);
+   _mm_storeu_ps(d + 8, b);
+   _mm_storeu_ps(d + 12, a);
+}
+
+static void
+r16g16b16a16_float_unpack_rgba_float_block(void *dst, const void *src)
+{
+   const uint8_t *s = src;
+   float *d = dst;
+
+   for (unsigned i = 0; i < BLOCK_PIXELS; i += 2) {
+      __m128i v = _mm_loadu_si128((const __m128i *)(s + 8 * i));
+
+      _mm_storeu_ps(d + 4 * i, half_to_float(_mm_cvtepu16_epi32(v)));
+      _mm_storeu_ps(d + 4 * i + 4,
+                    half_to_float(_mm_cvtepu16_epi32(_mm_srli_si128(v, 8))));
+   }
+}
+
+void
+util_format_r8g8b8a8_unorm_unpack_rgba_float_sse41(void *dst_row, unsigned dst_stride, const uint8_t *src_row, unsigned src_stride, unsigned width, unsigned height)
+{
+   convert_rows(dst_row, dst_stride, 16, src_row, src_stride, 4,
+                width, height, r8g8b8a8_unorm_unpack_rgba_float_block);
+}
+
+void
+util_format_r8g8b8a8_unorm_pack_rgba_float_sse41(uint8_t *dst_row, unsigned dst_stride, const float *src_row, unsigned src_stride, unsigned width, unsigned height)
+{
+   convert_rows(dst_row, dst_stride, 4, (const uint8_t *)src_row, src_stride, 16,
+                width, height, r8g8b8a8_unorm_pack_rgba_float_block);
+}
+
+void
+util_format_b8g8r8a8_unorm_unpack_rgba_float_sse41(void *dst_row, unsigned dst_stride, const uint8_t *src_row, unsigned src_stride, unsigned width, unsigned height)
+{
+   convert_rows(dst_row, dst_stride, 16, src_row, src_stride, 4,
+                width, height, b8g8r8a8_unorm_unpack_rgba_float_block);
+}
+
+void
+util_format_b8g8r8a8_unorm_pack_rgba_float_sse41(uint8_t *dst_row, unsigned dst_stride, const float *src_row, unsigned src_stride, unsigned width, unsigned height)
+{
+   convert_rows(dst_row, dst_stride, 4, (const uint8_t *)src_row, src_stride, 16,
+                width, height, b8g8r8a8_unorm_pack_rgba_float_block);
+}
+
+void
+util_format_b8g8r8a8_unorm_unpack_rgba_8unorm_sse41(uint8_t *dst_row, unsigned dst_stride, const uint8_t *src_row, unsigned src_stride, unsigned width, unsigned height)
+{
+   convert_rows(dst_row, dst_stride, 4, src_row, src_stride, 4,
+                width, height, b8g8r8a8_unorm_swizzle_8unorm_block);
+}
+
+void
+util_format_b8g8r8a8_unorm_pack_rgba_8unorm_sse41(uint8_t *dst_row, unsigned dst_stride, const uint8_t *src_row, unsigned src_stride, unsigned width, unsigned height)
+{
+   convert_rows(dst_row, dst_stride, 4, src_row, src_stride, 4,
+                width, height, b8g8r8a8_unorm_swizzle_8unorm_block);
+}
+
+void
+util_format_r8g8b8x8_unorm_unpack_rgba_float_sse41(void *dst_row, unsigned dst_stride, const uint8_t *src_row, unsigned src_stride, unsigned width, unsigned height)
+{
+   convert_rows(dst_row, dst_stride, 16, src_row, src_stride, 4,
+                width, height, r8g8b8x8_unorm_unpack_rgba_float_block);
+}
+
+void
+util_format_b8g8r8x8_unorm_unpack_rgba_float_sse41(void *dst_row, unsigned dst_stride, const uint8_t *src_row, unsigned src_stride, unsigned width, unsigned height)
+{
+   convert_rows(dst_row, dst_stride, 16, src_row, src_stride, 4,
+                width, height, b8g8r8x8_unorm_unpack_rgba_float_block);
+}
+
+void
+util_format_b8g8r8x8_unorm_unpack_rgba_8unorm_sse41(uint8_t *dst_row, unsigned dst_stride, const uint8_t *src_row, unsigned src_stride, unsigned width, unsigned height)
+{
+   convert_rows(dst_row, dst_stride, 4, src_row, src_stride, 4,
+                width, height, b8g8r8x8_unorm_unpack_rgba_8unorm_block);
+}
+
+void
+util_format_r10g10b10a2_unorm_unpack_rgba_float_sse41(void *dst_row, unsigned dst_stride, const uint8_t *src_row, unsigned src_stride, unsigned width, unsigned height)
+{
+   convert_rows(dst_row, dst_stride, 16, src_row, src_stride, 4,
+                width, height, r10g10b10a2_unorm_unpack_rgba_float_block);
+}
+
+void
+util_format_r16g16b16a16_float_unpack_rgba_float_sse41(void *dst_row, unsigned dst_stride, const uint8_t *src_row, unsigned src_stride, unsigned width, unsigned height)
+{
+   convert_rows(dst_row, dst_stride, 16, src_row, src_stride, 8,
+                width, height, r16g16b16a16_float_unpack_rgba_float_block);
+}
@@ -78,6 +78,22 @@ swizzle_map = {
     SWIZZLE_NONE: "PIPE_SWIZZLE_NONE",
 }
 
+# Row functions in u_format_sse41.c that replace the generated ones when the
+# CPU has SSE4.1, by description field.  They are named like the generated
+# function with an _sse41 suffix.
+sse41_kernels = {
+    'PIPE_FORMAT_R8G8B8A8_UNORM': ['unpack_rgba', 'pack_rgba_float'],
+    'PIPE_FORMAT_B8G8R8A8_UNORM': ['unpack_rgba', 'pack_rgba_float',
+                                   'unpack_rgba_8unorm', 'pack_rgba_8unorm'],
+    'PIPE_FORMAT_R8G8B8X8_UNORM': ['unpack_rgba'],
+    'PIPE_FORMAT_B8G8R8X8_UNORM': ['unpack_rgba', 'unpack_rgba_8unorm'],
+    'PIPE_FORMAT_R10G10B10A2_UNORM': ['unpack_rgba'],
+    'PIPE_FORMAT_R16G16B16A16_FLOAT': ['unpack_rgba'],
+}
+
+def sse41_fields(name, type):
+    return [f for f in sse41_kernels.get(name, []) if f.startswith(type)]
+
 def has_access(format):
     # We don't generate code for YUV formats, and many of the new ones lack
     # pack/unpack functions for softpipe/llvmpipe.
@@ -127,6 +143,11 @@ def write_format_table(formats):
     print('#include "u_format_rgtc.h"')
     print('#include "u_format_latc.h"')
     print('#include "u_format_etc.h"')
+    print('#include "util/u_cpu_detect.h"')
+    print()
+    print('#ifdef USE_SSE41')
+    print('#include "u_format_sse41.h"')
+    print('#endif')
     print()
 
     write_format_table_header(sys.stdout2)
@@ -169,6 +190,22 @@ def write_format_table(formats):
         print("   if (format >= ARRAY_SIZE(util_format_%sdescriptions))" % (type))
         print("      return NULL;")
         print()
+        if type in ('pack_', 'unpack_'):
+            print("#ifdef USE_SSE41")
+            print("   if (util_cpu_caps.has_sse4_1) {")
+            print("      switch (format) {")
+            for name in sorted(sse41_kernels):
+                if not sse41_fields(name, type):
+                    continue
+                sn = name[len('PIPE_FORMAT_'):].lower()
+                print("      case %s:" % name)
+                print("         return &util_format_%s_%sdescription_sse41;" % (sn, type))
+            print("      default:")
+            print("         break;")
+            print("      }")
+            print("   }")
+            print("#endif")
+            print()
         print("   return &util_format_%sdescriptions[format];" % (type))
         print("}")
         print()
@@ -199,70 +236,99 @@ def write_format_table(formats):
     print()
     generate_table_getter("")
 
-    print('static const struct util_format_pack_description')
-    print('util_format_pack_descriptions[] = {')
-    for format in formats:
-        sn = format.short_name()
+    def print_function(format, field, function, type, sse41):
+        name = "util_format_%s_%s" % (format.short_name(), function)
+        if sse41 and field in sse41_fields(format.name, type):
+            name += "_sse41"
+        indent = "   " if sse41 else "      "
+        print("%s.%s = &%s," % (indent, field, name))
 
-        if not has_access(format):
-            print("   [%s] = { 0 }," % (format.name,))
-            continue
+    def print_pack_functions(format, sse41):
+        def do(field, function):
+            print_function(format, field, function, "pack_", sse41)
 
-        print("   [%s] = {" % (format.name,))
         if format.colorspace != ZS and not format.is_pure_color():
-            print("      .pack_rgba_8unorm = &util_format_%s_pack_rgba_8unorm," % sn)
-            print("      .pack_rgba_float = &util_format_%s_pack_rgba_float," % sn)
+            do("pack_rgba_8unorm", "pack_rgba_8unorm")
+            do("pack_rgba_float", "pack_rgba_float")
 
         if format.has_depth():
-            print("      .pack_z_32unorm = &util_format_%s_pack_z_32unorm," % sn)
-            print("      .pack_z_float = &util_format_%s_pack_z_float," % sn)
+            do("pack_z_32unorm", "pack_z_32unorm")
+            do("pack_z_float", "pack_z_float")
 
         if format.has_stencil():
-            print("      .pack_s_8uint = &util_format_%s_pack_s_8uint," % sn)
+            do("pack_s_8uint", "pack_s_8uint")
 
         if format.is_pure_unsigned() or format.is_pure_signed():
-            print("      .pack_rgba_uint = &util_format_%s_pack_unsigned," % sn)
-            print("      .pack_rgba_sint = &util_format_%s_pack_signed," % sn)
+            do("pack_rgba_uint", "pack_unsigned")
+            do("pack_rgba_sint", "pack_signed")
+
+    def print_unpack_functions(format, sse41):
+        def do(field, function):
+            print_function(format, field, function, "unpack_", sse41)
+
+        if format.colorspace != ZS and not format.is_pure_color():
+            do("unpack_rgba_8unorm", "unpack_rgba_8unorm")
+            if format.layout == 's3tc' or format.layout == 'rgtc':
+                do("fetch_rgba_8unorm", "fetch_rgba_8unorm")
+            do("unpack_rgba", "unpack_rgba_float")
+            do("fetch_rgba_float", "fetch_rgba_float")
+
+        if format.has_depth():
+            do("unpack_z_32unorm", "unpack_z_32unorm")
+            do("unpack_z_float", "unpack_z_float")
+
+        if format.has_stencil():
+            do("unpack_s_8uint", "unpack_s_8uint")
+
+        if format.is_pure_unsigned():
+            do("unpack_rgba", "unpack_unsigned")
+            do("fetch_rgba_uint", "fetch_unsigned")
+        elif format.is_pure_signed():
+            do("unpack_rgba", "unpack_signed")
+            do("fetch_rgba_sint", "fetch_signed")
+
+    def print_sse41_descriptions(type, print_functions):
+        print("#ifdef USE_SSE41")
+        for format in formats:
+            if not sse41_fields(format.name, type):
+                continue
+            print("static const struct util_format_%sdescription" % type)
+            print("util_format_%s_%sdescription_sse41 = {" % (format.short_name(), type))
+            print_functions(format, True)
+            print("};")
+            print()
+        print("#endif")
+        print()
+
+    print('static const struct util_format_pack_description')
+    print('util_format_pack_descriptions[] = {')
+    for format in formats:
+        if not has_access(format):
+            print("   [%s] = { 0 }," % (format.name,))
+            continue
+
+        print("   [%s] = {" % (format.name,))
+        print_pack_functions(format, False)
         print("   },")
         print()
     print("};")
     print()
+    print_sse41_descriptions("pack_", print_pack_functions)
     generate_table_getter("pack_")
 
     print('static const struct util_format_unpack_description')
     print('util_format_unpack_descriptions[] = {')
     for format in formats:
-        sn = format.short_name()
-
         if not has_access(format):
             print("   [%s] = { 0 }," % (format.name,))
             continue
 
         print("   [%s] = {" % (format.name,))
-        if format.colorspace != ZS and not format.is_pure_color():
-            print("      .unpack_rgba_8unorm = &util_format_%s_unpack_rgba_8unorm," % sn)
-            if format.layout == 's3tc' or format.layout == 'rgtc':
-                print("      .fetch_rgba_8unorm = &util_format_%s_fetch_rgba_8unorm," % sn)
-            print("      .unpack_rgba = &util_format_%s_unpack_rgba_float," % sn)
-            print("      .fetch_rgba_float = &util_format_%s_fetch_rgba_float," % sn)
-
-        if format.has_depth():
-            print("      .unpack_z_32unorm = &util_format_%s_unpack_z_32unorm," % sn)
-            print("      .unpack_z_float = &util_format_%s_unpack_z_float," % sn)
-
-        if format.has_stencil():
-            print("      .unpack_s_8uint = &util_format_%s_unpack_s_8uint," % sn)
-
-        if format.is_pure_unsigned():
-            print("      .unpack_rgba = &util_format_%s_unpack_unsigned," % sn)
-            print("      .fetch_rgba_uint = &util_format_%s_fetch_unsigned," % sn)
-        elif format.is_pure_signed():
-            print("      .unpack_rgba = &util_format_%s_unpack_signed," % sn)
-            print("      .fetch_rgba_sint = &util_format_%s_fetch_signed," % sn)
+        print_unpack_functions(format, False)
         print("   },")
     print("};")
     print()
-
+    print_sse41_descriptions("unpack_", print_unpack_functions)
     generate_table_getter("unpack_")
 
 def main():
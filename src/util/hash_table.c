@@ -45,7 +45,9 @@
 #include <assert.h>
 
 #include "hash_table.h"
+#include "hash_table_group.h"
 #include "ralloc.h"
+#include "bitscan.h"
 #include "macros.h"
 #include "u_memory.h"
 #include "fast_urem_by_const.h"
@@ -164,6 +166,7 @@ _mesa_hash_table_init(struct hash_table *ht,
    ht->entries = 0;
    ht->deleted_entries = 0;
    ht->deleted_key = &deleted_key_value;
+   ht->ctrl = NULL;
 
    return ht->table != NULL;
 }
@@ -210,6 +213,15 @@ _mesa_hash_table_clone(struct hash_table *src, void *dst_mem_ctx)
 
    memcpy(ht->table, src->table, ht->size * sizeof(struct hash_entry));
 
+   if (src->ctrl) {
+      ht->ctrl = ralloc_array(ht->table, uint8_t, ht->size);
+      if (ht->ctrl == NULL) {
+         ralloc_free(ht);
+         return NULL;
+      }
+      memcpy(ht->ctrl, src->ctrl, ht->size);
+   }
+
    return ht;
 }
 
@@ -256,6 +268,9 @@ _mesa_hash_table_clear(struct hash_table *ht,
       entry->key = NULL;
    }
 
+   if (ht->ctrl)
+      memset(ht->ctrl, HASH_CTRL_EMPTY, ht->size);
+
    ht->entries = 0;
    ht->deleted_entries = 0;
 }
@@ -276,11 +291,108 @@ _mesa_hash_table_set_deleted_key(struct hash_table *ht, const void *deleted_key)
    ht->deleted_key = deleted_key;
 }
 
+/**
+ * Allocates the entries and control bytes of a group-probed table with
+ * 2^size_index groups.  The control bytes are a child of the entry array, so
+ * that freeing the entries frees both.
+ */
+static bool
+hash_table_alloc_grouped(struct hash_table *ht, void *mem_ctx,
+                         unsigned size_index)
+{
+   uint32_t size = HASH_GROUP_SIZE << size_index;
+   struct hash_entry *table;
+   uint8_t *ctrl;
+
+   table = rzalloc_array(mem_ctx, struct hash_entry, size);
+   if (table == NULL)
+      return false;
+
+   ctrl = ralloc_array(table, uint8_t, size);
+   if (ctrl == NULL) {
+      ralloc_free(table);
+      return false;
+   }
+   memset(ctrl, HASH_CTRL_EMPTY, size);
+
+   ht->table = table;
+   ht->ctrl = ctrl;
+   ht->size_index = size_index;
+   ht->size = size;
+   ht->rehash = 0;
+   ht->size_magic = 0;
+   ht->rehash_magic = 0;
+   /* Keep at least one slot in eight empty so that probes terminate early. */
+   ht->max_entries = size - size / 8;
+   ht->entries = 0;
+   ht->deleted_entries = 0;
+
+   return true;
+}
+
+/**
+ * Switches an empty table to group probing.
+ *
+ * Instead of double hashing over a prime-sized table, the table keeps a
+ * 7-bit tag of each hash in a separate control byte array, and lookups scan
+ * a group of 16 tags at once (with SSE2 where available) before looking at
+ * any entry.  This pays off for tables with many lookups, especially misses,
+ * and expensive key comparisons.  Iteration and the hash_entry pointers
+ * returned behave exactly as in the default layout.
+ *
+ * Returns false if the allocation failed, leaving the table unchanged.
+ */
+bool
+_mesa_hash_table_enable_group_probing(struct hash_table *ht)
+{
+   struct hash_entry *old_table = ht->table;
+
+   assert(ht->entries == 0 && ht->deleted_entries == 0);
+
+   if (!hash_table_alloc_grouped(ht, ralloc_parent(old_table), 0))
+      return false;
+
+   ralloc_free(old_table);
+   return true;
+}
+
+static struct hash_entry *
+hash_table_search_grouped(struct hash_table *ht, uint32_t hash,
+                          const void *key)
+{
+   uint32_t group_mask = (ht->size / HASH_GROUP_SIZE) - 1;
+   uint32_t group = hash_group_start(hash, ht->size_index);
+   uint8_t tag = hash_group_tag(hash);
+
+   for (uint32_t i = 1; i <= group_mask + 1; i++) {
+      const uint8_t *ctrl = ht->ctrl + group * HASH_GROUP_SIZE;
+      struct hash_entry *group_entries = ht->table + group * HASH_GROUP_SIZE;
+      unsigned match = hash_group_match(ctrl, tag);
+
+      while (match) {
+         struct hash_entry *entry = group_entries + u_bit_scan(&match);
+
+         if (entry->hash == hash && ht->key_equals_function(key, entry->key))
+            return entry;
+      }
+
+      if (hash_group_match_empty(ctrl))
+         return NULL;
+
+      group = (group + i) & group_mask;
+   }
+
+   return NULL;
+}
+
 static struct hash_entry *
 hash_table_search(struct hash_table *ht, uint32_t hash, const void *key)
 {
    assert(!key_pointer_is_reserved(ht, key));
 
+   if (ht->ctrl)
+      return hash_table_search_grouped(ht, hash, key);
+
    uint32_t size = ht->size;
    uint32_t start_hash_address = util_fast_urem32(hash, size, ht->size_magic);
    uint32_t double_hash = 1 + util_fast_urem32(hash, ht->rehash,
@@ -331,10 +443,43 @@ static struct hash_entry *
 hash_table_insert(struct hash_table *ht, uint32_t hash,
                   const void *key, void *data);
 
+/**
+ * Returns the first slot available for a new entry with the given hash,
+ * or -1 if the table is full.
+ */
+static int
+hash_table_find_available_grouped(struct hash_table *ht, uint32_t hash)
+{
+   uint32_t group_mask = (ht->size / HASH_GROUP_SIZE) - 1;
+   uint32_t group = hash_group_start(hash, ht->size_index);
+
+   for (uint32_t i = 1; i <= group_mask + 1; i++) {
+      unsigned available =
+         hash_group_match_available(ht->ctrl + group * HASH_GROUP_SIZE);
+
+      if (available)
+         return group * HASH_GROUP_SIZE + ffs(available) - 1;
+
+      group = (group + i) & group_mask;
+   }
+
+   return -1;
+}
+
 static void
 hash_table_insert_rehash(struct hash_table *ht, uint32_t hash,
                          const void *key, void *data)
 {
+   if (ht->ctrl) {
+      int i = hash_table_find_available_grouped(ht, hash);
+      assert(i >= 0);
+      ht->ctrl[i] = hash_group_tag(hash);
+      ht->table[i].hash = hash;
+      ht->table[i].key = key;
+      ht->table[i].data = data;
+      return;
+   }
+
    uint32_t size = ht->size;
    uint32_t start_hash_address = util_fast_urem32(hash, size, ht->size_magic);
    uint32_t double_hash = 1 + util_fast_urem32(hash, ht->rehash,
@@ -362,6 +507,25 @@ _mesa_hash_table_rehash(struct hash_table *ht, unsigned new_size_index)
    struct hash_table old_ht;
    struct hash_entry *table;
 
+   if (ht->ctrl) {
+      if (new_size_index > HASH_GROUP_MAX_SIZE_INDEX)
+         return;
+
+      old_ht = *ht;
+      if (!hash_table_alloc_grouped(ht, ralloc_parent(ht->table),
+                                    new_size_index))
+         return;
+
+      hash_table_foreach(&old_ht, entry) {
+         hash_table_insert_rehash(ht, entry->hash, entry->key, entry->data);
+      }
+
+      ht->entries = old_ht.entries;
+
+      ralloc_free(old_ht.table);
+      return;
+   }
+
    if (new_size_index >= ARRAY_SIZE(hash_sizes))
       return;
 
@@ -391,6 +555,61 @@ _mesa_hash_table_rehash(struct hash_table *ht, unsigned new_size_index)
    ralloc_free(old_ht.table);
 }
 
+static struct hash_entry *
+hash_table_insert_grouped(struct hash_table *ht, uint32_t hash,
+                          const void *key, void *data)
+{
+   uint32_t group_mask = (ht->size / HASH_GROUP_SIZE) - 1;
+   uint32_t group = hash_group_start(hash, ht->size_index);
+   uint8_t tag = hash_group_tag(hash);
+   int available = -1;
+
+   for (uint32_t i = 1; i <= group_mask + 1; i++) {
+      const uint8_t *ctrl = ht->ctrl + group * HASH_GROUP_SIZE;
+      struct hash_entry *group_entries = ht->table + group * HASH_GROUP_SIZE;
+      unsigned match = hash_group_match(ctrl, tag);
+
+      /* Replace the entry if the key is already present, see
+       * hash_table_insert().
+       */
+      while (match) {
+         struct hash_entry *entry = group_entries + u_bit_scan(&match);
+
+         if (entry->hash == hash && ht->key_equals_function(key, entry->key)) {
+            entry->key = key;
+            entry->data = data;
+            return entry;
+         }
+      }
+
+      /* Stash the first available slot we find */
+      if (available < 0) {
+         unsigned mask = hash_group_match_available(ctrl);
+         if (mask)
+            available = group * HASH_GROUP_SIZE + ffs(mask) - 1;
+      }
+
+      if (hash_group_match_empty(ctrl))
+         break;
+
+      group = (group + i) & group_mask;
+   }
+
+   if (available < 0) {
+      /* We could hit here if a required resize failed. */
+      return NULL;
+   }
+
+   if (ht->ctrl[available] == HASH_CTRL_DELETED)
+      ht->deleted_entries--;
+   ht->ctrl[available] = tag;
+   ht->table[available].hash = hash;
+   ht->table[available].key = key;
+   ht->table[available].data = data;
+   ht->entries++;
+   return &ht->table[available];
+}
+
 static struct hash_entry *
 hash_table_insert(struct hash_table *ht, uint32_t hash,
                   const void *key, void *data)
@@ -405,6 +624,9 @@ hash_table_insert(struct hash_table *ht, uint32_t hash,
       _mesa_hash_table_rehash(ht, ht->size_index);
    }
 
+   if (ht->ctrl)
+      return hash_table_insert_grouped(ht, hash, key, data);
+
    uint32_t size = ht->size;
    uint32_t start_hash_address = util_fast_urem32(hash, size, ht->size_magic);
    uint32_t double_hash = 1 + util_fast_urem32(hash, ht->rehash,
@@ -496,6 +718,8 @@ _mesa_hash_table_remove(struct hash_table *ht,
       return;
 
    entry->key = ht->deleted_key;
+   if (ht->ctrl)
+      ht->ctrl[entry - ht->table] = HASH_CTRL_DELETED;
    ht->entries--;
    ht->deleted_entries++;
 }
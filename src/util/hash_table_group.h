@@ -0,0 +1,152 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * Helpers for the group-probed layout shared by hash_table.c and set.c.
+ *
+ * A group-probed table is split into groups of HASH_GROUP_SIZE slots.  Next
+ * to the entry array it keeps one control byte per slot, which is either
+ * HASH_CTRL_EMPTY, HASH_CTRL_DELETED, or a 7-bit tag derived from the hash
+ * of the key stored in the slot.  A lookup compares the tag against a whole
+ * group of control bytes at once and only touches the entries whose tag
+ * matches, and it stops at the first group that has an empty slot.
+ *
+ * Groups are probed in triangular order, which visits every group exactly
+ * once since the number of groups is a power of two.
+ */
+
+#ifndef HASH_TABLE_GROUP_H
+#define HASH_TABLE_GROUP_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "u_math.h"
+
+#if defined(__SSE2__) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) || defined(_M_X64)
+#include <emmintrin.h>
+#define HASH_GROUP_SSE2 1
+#endif
+
+#define HASH_GROUP_SIZE 16
+
+/* The largest supported size index, giving 2^31 slots. */
+#define HASH_GROUP_MAX_SIZE_INDEX 27
+
+/* Both markers have the top bit set, while tags never do. */
+#define HASH_CTRL_EMPTY   0x80
+#define HASH_CTRL_DELETED 0xfe
+
+static inline uint32_t
+hash_group_mix(uint32_t hash)
+{
+   /* Fibonacci hashing, so that hash functions with weak high bits (like
+    * _mesa_hash_pointer) still spread over the groups.
+    */
+   return hash * 0x9e3779b1u;
+}
+
+/** Returns the first group to probe in a table of 2^size_index groups. */
+static inline uint32_t
+hash_group_start(uint32_t hash, unsigned size_index)
+{
+   return (uint32_t)(((uint64_t)hash_group_mix(hash) << size_index) >> 32);
+}
+
+static inline uint8_t
+hash_group_tag(uint32_t hash)
+{
+   return hash_group_mix(hash) & 0x7f;
+}
+
+#ifndef HASH_GROUP_SSE2
+#define HASH_GROUP_BYTES_LO 0x0101010101010101ull
+#define HASH_GROUP_BYTES_HI 0x8080808080808080ull
+
+static inline uint64_t
+hash_group_load_word(const uint8_t *ctrl)
+{
+   uint64_t word;
+   memcpy(&word, ctrl, sizeof(word));
+   return util_le64_to_cpu(word);
+}
+
+/**
+ * Gathers the top bit of each byte of x (all other bits clear) into the low
+ * 8 bits of the result, with byte 0 in bit 0.
+ */
+static inline unsigned
+hash_group_gather_word(uint64_t x)
+{
+   return (unsigned)(((x >> 7) * 0x0102040810204080ull) >> 56);
+}
+
+/** Returns a mask of the bytes of word that are equal to byte. */
+static inline unsigned
+hash_group_match_word(uint64_t word, uint8_t byte)
+{
+   uint64_t x = word ^ (HASH_GROUP_BYTES_LO * byte);
+   uint64_t low7 = ~HASH_GROUP_BYTES_HI;
+
+   /* Sets the top bit of exactly the bytes of x that are zero. */
+   uint64_t zero = ~(((x & low7) + low7) | x) & HASH_GROUP_BYTES_HI;
+
+   return hash_group_gather_word(zero);
+}
+#endif
+
+/** Returns a mask of the slots in the group whose control byte is tag. */
+static inline unsigned
+hash_group_match(const uint8_t *ctrl, uint8_t tag)
+{
+#ifdef HASH_GROUP_SSE2
+   __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+   return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(tag)));
+#else
+   return hash_group_match_word(hash_group_load_word(ctrl), tag) |
+          hash_group_match_word(hash_group_load_word(ctrl + 8), tag) << 8;
+#endif
+}
+
+/** Returns a mask of the empty slots in the group. */
+static inline unsigned
+hash_group_match_empty(const uint8_t *ctrl)
+{
+   return hash_group_match(ctrl, HASH_CTRL_EMPTY);
+}
+
+/** Returns a mask of the empty or deleted slots in the group. */
+static inline unsigned
+hash_group_match_available(const uint8_t *ctrl)
+{
+#ifdef HASH_GROUP_SSE2
+   return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)ctrl));
+#else
+   uint64_t lo = hash_group_load_word(ctrl) & HASH_GROUP_BYTES_HI;
+   uint64_t hi = hash_group_load_word(ctrl + 8) & HASH_GROUP_BYTES_HI;
+
+   return hash_group_gather_word(lo) | hash_group_gather_word(hi) << 8;
+#endif
+}
+
+#endif /* HASH_TABLE_GROUP_H */
@@ -70,7 +70,10 @@ __declspec(align(16))
    unsigned canary;
 #endif
 
-   struct ralloc_header *parent;
+   /* The parent header.  The low bit is HAS_DESTRUCTOR_SLOT, use
+    * get_parent()/set_parent() to access it.
+    */
+   uintptr_t parent;
 
    /* The first child (head of a linked list) */
    struct ralloc_header *child;
@@ -78,12 +81,20 @@ __declspec(align(16))
    /* Linked list of siblings */
    struct ralloc_header *prev;
    struct ralloc_header *next;
-
-   void (*destructor)(void *);
 };
 
 typedef struct ralloc_header ralloc_header;
 
+typedef void (*ralloc_destructor)(void *);
+
+/* Most blocks never get a destructor, so it isn't part of the header.
+ * Blocks allocated with ralloc_size_with_destructor() store it in a slot
+ * in front of the header instead.  Two pointers keep the header aligned
+ * the same way as above.
+ */
+#define HAS_DESTRUCTOR_SLOT  0x1
+#define DESTRUCTOR_SLOT_SIZE (2 * sizeof(void *))
+
 static void unlink_block(ralloc_header *info);
 static void unsafe_free(ralloc_header *info);
 
@@ -98,11 +109,43 @@ get_header(const void *ptr)
 
 #define PTR_FROM_HEADER(info) (((char *) info) + sizeof(ralloc_header))
 
+static inline ralloc_header *
+get_parent(const ralloc_header *info)
+{
+   return (ralloc_header *) (info->parent & ~(uintptr_t)HAS_DESTRUCTOR_SLOT);
+}
+
+static inline void
+set_parent(ralloc_header *info, ralloc_header *parent)
+{
+   info->parent = (uintptr_t) parent |
+                  (info->parent & HAS_DESTRUCTOR_SLOT);
+}
+
+static inline ralloc_destructor *
+get_destructor_slot(ralloc_header *info)
+{
+   if (!(info->parent & HAS_DESTRUCTOR_SLOT))
+      return NULL;
+
+   return (ralloc_destructor *) (((char *) info) - DESTRUCTOR_SLOT_SIZE);
+}
+
+/* The start of the malloc'ed memory of a block */
+static inline void *
+get_block(ralloc_header *info)
+{
+   if (info->parent & HAS_DESTRUCTOR_SLOT)
+      return ((char *) info) - DESTRUCTOR_SLOT_SIZE;
+
+   return info;
+}
+
 static void
 add_child(ralloc_header *parent, ralloc_header *info)
 {
    if (parent != NULL) {
-      info->parent = parent;
+      set_parent(info, parent);
       info->next = parent->child;
       parent->child = info;
 
@@ -117,26 +160,42 @@ ralloc_context(const void *ctx)
    return ralloc_size(ctx, 0);
 }
 
-void *
-ralloc_size(const void *ctx, size_t size)
+static inline ralloc_header *
+alloc_block(size_t size, bool destructor_slot)
 {
-   void *block = malloc(size + sizeof(ralloc_header));
+   const size_t slot_size = destructor_slot ? DESTRUCTOR_SLOT_SIZE : 0;
+   char *block = malloc(slot_size + sizeof(ralloc_header) + size);
    ralloc_header *info;
-   ralloc_header *parent;
 
    if (unlikely(block == NULL))
       return NULL;
 
-   info = (ralloc_header *) block;
+   info = (ralloc_header *) (block + slot_size);
    /* measurements have shown that calloc is slower (because of
     * the multiplication overflow checking?), so clear things
     * manually
     */
-   info->parent = NULL;
+   info->parent = 0;
    info->child = NULL;
    info->prev = NULL;
    info->next = NULL;
-   info->destructor = NULL;
+
+   if (destructor_slot) {
+      info->parent = HAS_DESTRUCTOR_SLOT;
+      *(ralloc_destructor *) block = NULL;
+   }
+
+   return info;
+}
+
+void *
+ralloc_size(const void *ctx, size_t size)
+{
+   ralloc_header *info = alloc_block(size, false);
+   ralloc_header *parent;
+
+   if (unlikely(info == NULL))
+      return NULL;
 
    parent = ctx != NULL ? get_header(ctx) : NULL;
 
@@ -160,22 +219,63 @@ rzalloc_size(const void *ctx, size_t size)
    return ptr;
 }
 
+void *
+ralloc_size_with_destructor(const void *ctx, size_t size,
+                            void (*destructor)(void *))
+{
+   ralloc_header *info = alloc_block(size, true);
+   ralloc_header *parent;
+
+   if (unlikely(info == NULL))
+      return NULL;
+
+   *get_destructor_slot(info) = destructor;
+
+   parent = ctx != NULL ? get_header(ctx) : NULL;
+
+   add_child(parent, info);
+
+#ifndef NDEBUG
+   info->canary = CANARY;
+#endif
+
+   return PTR_FROM_HEADER(info);
+}
+
+void *
+rzalloc_size_with_destructor(const void *ctx, size_t size,
+                             void (*destructor)(void *))
+{
+   void *ptr = ralloc_size_with_destructor(ctx, size, destructor);
+
+   if (likely(ptr))
+      memset(ptr, 0, size);
+
+   return ptr;
+}
+
 /* helper function - assumes ptr != NULL */
 static void *
 resize(void *ptr, size_t size)
 {
-   ralloc_header *child, *old, *info;
+   ralloc_header *child, *old, *info, *parent;
+   size_t slot_size;
+   char *block;
 
    old = get_header(ptr);
-   info = realloc(old, size + sizeof(ralloc_header));
+   slot_size = (old->parent & HAS_DESTRUCTOR_SLOT) ? DESTRUCTOR_SLOT_SIZE : 0;
+   block = realloc(get_block(old), slot_size + size + sizeof(ralloc_header));
 
-   if (info == NULL)
+   if (block == NULL)
       return NULL;
 
+   info = (ralloc_header *) (block + slot_size);
+   parent = get_parent(info);
+
    /* Update parent and sibling's links to the reallocated node. */
-   if (info != old && info->parent != NULL) {
-      if (info->parent->child == old)
-	 info->parent->child = info;
+   if (info != old && parent != NULL) {
+      if (parent->child == old)
+	 parent->child = info;
 
       if (info->prev != NULL)
 	 info->prev->next = info;
@@ -186,7 +286,7 @@ resize(void *ptr, size_t size)
 
    /* Update child->parent links for all children */
    for (child = info->child; child != NULL; child = child->next)
-      child->parent = info;
+      set_parent(child, info);
 
    return PTR_FROM_HEADER(info);
 }
@@ -269,10 +369,12 @@ ralloc_free(void *ptr)
 static void
 unlink_block(ralloc_header *info)
 {
+   ralloc_header *parent = get_parent(info);
+
    /* Unlink from parent & siblings */
-   if (info->parent != NULL) {
-      if (info->parent->child == info)
-	 info->parent->child = info->next;
+   if (parent != NULL) {
+      if (parent->child == info)
+	 parent->child = info->next;
 
       if (info->prev != NULL)
 	 info->prev->next = info->next;
@@ -280,7 +382,7 @@ unlink_block(ralloc_header *info)
       if (info->next != NULL)
 	 info->next->prev = info->prev;
    }
-   info->parent = NULL;
+   set_parent(info, NULL);
    info->prev = NULL;
    info->next = NULL;
 }
@@ -290,6 +392,8 @@ unsafe_free(ralloc_header *info)
 {
    /* Recursively free any children...don't waste time unlinking them. */
    ralloc_header *temp;
+   ralloc_destructor *destructor;
+
    while (info->child != NULL) {
       temp = info->child;
       info->child = temp->next;
@@ -297,10 +401,11 @@ unsafe_free(ralloc_header *info)
    }
 
    /* Free the block itself.  Call the destructor first, if any. */
-   if (info->destructor != NULL)
-      info->destructor(PTR_FROM_HEADER(info));
+   destructor = get_destructor_slot(info);
+   if (destructor != NULL && *destructor != NULL)
+      (*destructor)(PTR_FROM_HEADER(info));
 
-   free(info);
+   free(get_block(info));
 }
 
 void
@@ -336,9 +441,9 @@ ralloc_adopt(const void *new_ctx, void *old_ctx)
 
    /* Set all the children's parent to new_ctx; get a pointer to the last child. */
    for (child = old_info->child; child->next != NULL; child = child->next) {
-      child->parent = new_info;
+      set_parent(child, new_info);
    }
-   child->parent = new_info;
+   set_parent(child, new_info);
 
    /* Connect the two lists together; parent them to new_ctx; make old_ctx empty. */
    child->next = new_info->child;
@@ -357,14 +462,28 @@ ralloc_parent(const void *ptr)
       return NULL;
 
    info = get_header(ptr);
-   return info->parent ? PTR_FROM_HEADER(info->parent) : NULL;
+   return get_parent(info) ? PTR_FROM_HEADER(get_parent(info)) : NULL;
 }
 
 void
 ralloc_set_destructor(const void *ptr, void(*destructor)(void *))
 {
    ralloc_header *info = get_header(ptr);
-   info->destructor = destructor;
+   ralloc_destructor *slot = get_destructor_slot(info);
+
+   /* Only blocks from ralloc_size_with_destructor() have room for one;
+    * dropping the destructor silently would leak whatever it releases.
+    */
+   if (slot == NULL) {
+      if (destructor != NULL) {
+         fprintf(stderr, "ralloc_set_destructor: %p was not allocated "
+                 "with ralloc_size_with_destructor()\n", ptr);
+         abort();
+      }
+      return;
+   }
+
+   *slot = destructor;
 }
 
 char *
@@ -52,6 +52,10 @@
 
 #include "macros.h"
 
+#ifdef __cplusplus
+#include <type_traits>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -107,6 +111,24 @@ void *ralloc_size(const void *ctx, size_t size) MALLOCLIKE;
  */
 void *rzalloc_size(const void *ctx, size_t size) MALLOCLIKE;
 
+/**
+ * Allocate memory chained off of the given context, with a callback that
+ * occurs just before it is freed.
+ *
+ * Only memory allocated this way can get a destructor, see
+ * ralloc_set_destructor().  Other allocations don't reserve room for one,
+ * which keeps their header small.
+ */
+void *ralloc_size_with_destructor(const void *ctx, size_t size,
+                                  void (*destructor)(void *)) MALLOCLIKE;
+
+/**
+ * Allocate zero-initialized memory with a destructor, see
+ * ralloc_size_with_destructor().
+ */
+void *rzalloc_size_with_destructor(const void *ctx, size_t size,
+                                   void (*destructor)(void *)) MALLOCLIKE;
+
 /**
  * Resize a piece of ralloc-managed memory, preserving data.
  *
@@ -310,6 +332,10 @@ void *ralloc_parent(const void *ptr);
 
 /**
  * Set a callback to occur just before an object is freed.
+ *
+ * \p ptr must have been allocated with ralloc_size_with_destructor() or
+ * rzalloc_size_with_destructor(), unless \p destructor is NULL.  Setting a
+ * destructor on any other block aborts.
  */
 void ralloc_set_destructor(const void *ptr, void(*destructor)(void *));
 
@@ -487,8 +513,31 @@ bool ralloc_vasprintf_append(char **str, const char *fmt, va_list args);
  * delete var;
  *
  * which is more idiomatic in C++ than calling ralloc.
+ *
+ * Linear allocations have no room for a destructor and are only freed
+ * with their parent, so TYPE must be trivially destructible.
  */
-#define DECLARE_ALLOC_CXX_OPERATORS_TEMPLATE(TYPE, ALLOC_FUNC)           \
+#define DECLARE_LINEAR_ALLOC_CXX_OPERATORS_TEMPLATE(TYPE, ALLOC_FUNC)    \
+public:                                                                  \
+   static void* operator new(size_t size, void *mem_ctx)                 \
+   {                                                                     \
+      static_assert(std::is_trivially_destructible<TYPE>::value,         \
+                    "linear allocations can't have a destructor");       \
+      void *p = ALLOC_FUNC(mem_ctx, size);                               \
+      assert(p != NULL);                                                 \
+      return p;                                                          \
+   }                                                                     \
+                                                                         \
+   static void operator delete(void *p)                                  \
+   {                                                                     \
+      ralloc_free(p);                                                    \
+   }
+
+/**
+ * Like DECLARE_LINEAR_ALLOC_CXX_OPERATORS_TEMPLATE, but for ralloc, where
+ * only objects with a non-trivial destructor reserve room for one.
+ */
+#define DECLARE_RALLOC_CXX_OPERATORS_TEMPLATE(TYPE, ALLOC_FUNC)          \
 private:                                                                 \
    static void _ralloc_destructor(void *p)                               \
    {                                                                     \
@@ -497,10 +546,10 @@ private:                                                                 \
 public:                                                                  \
    static void* operator new(size_t size, void *mem_ctx)                 \
    {                                                                     \
-      void *p = ALLOC_FUNC(mem_ctx, size);                               \
+      void *p = HAS_TRIVIAL_DESTRUCTOR(TYPE) ?                           \
+         ALLOC_FUNC(mem_ctx, size) :                                     \
+         ALLOC_FUNC##_with_destructor(mem_ctx, size, _ralloc_destructor);\
       assert(p != NULL);                                                 \
-      if (!HAS_TRIVIAL_DESTRUCTOR(TYPE))                                 \
-         ralloc_set_destructor(p, _ralloc_destructor);                   \
       return p;                                                          \
    }                                                                     \
                                                                          \
@@ -516,16 +565,16 @@ public:                                                                  \
    }
 
 #define DECLARE_RALLOC_CXX_OPERATORS(type) \
-   DECLARE_ALLOC_CXX_OPERATORS_TEMPLATE(type, ralloc_size)
+   DECLARE_RALLOC_CXX_OPERATORS_TEMPLATE(type, ralloc_size)
 
 #define DECLARE_RZALLOC_CXX_OPERATORS(type) \
-   DECLARE_ALLOC_CXX_OPERATORS_TEMPLATE(type, rzalloc_size)
+   DECLARE_RALLOC_CXX_OPERATORS_TEMPLATE(type, rzalloc_size)
 
 #define DECLARE_LINEAR_ALLOC_CXX_OPERATORS(type) \
-   DECLARE_ALLOC_CXX_OPERATORS_TEMPLATE(type, linear_alloc_child)
+   DECLARE_LINEAR_ALLOC_CXX_OPERATORS_TEMPLATE(type, linear_alloc_child)
 
 #define DECLARE_LINEAR_ZALLOC_CXX_OPERATORS(type) \
-   DECLARE_ALLOC_CXX_OPERATORS_TEMPLATE(type, linear_zalloc_child)
+   DECLARE_LINEAR_ALLOC_CXX_OPERATORS_TEMPLATE(type, linear_zalloc_child)
 
 
 /**
@@ -74,6 +74,7 @@
 #include <stdlib.h>
 
 #include "blob.h"
+#include "hash_table.h"
 #include "ralloc.h"
 #include "main/macros.h"
 #include "util/bitset.h"
@@ -81,6 +82,12 @@
 #include "u_math.h"
 #include "register_allocate.h"
 
+/**
+ * Above this many nodes, interference is tracked in a hash set of node pairs
+ * instead of a bitset per node, whose total size grows quadratically.
+ */
+#define RA_DENSE_GRAPH_MAX_NODES 4096
+
 struct ra_reg {
    BITSET_WORD *conflicts;
    struct util_dynarray conflict_list;
@@ -124,6 +131,8 @@ struct ra_node {
     *
     * List of which nodes this node interferes with.  This should be
     * symmetric with the other node.
+    *
+    * The bitset is NULL once the graph has switched to ra_graph::edges.
     */
    BITSET_WORD *adjacency;
 
@@ -169,6 +178,13 @@ struct ra_graph {
 
    unsigned int alloc; /**< count of nodes allocated. */
 
+   /**
+    * Set of interfering node pairs (see ra_edge_key()) replacing the
+    * per-node adjacency bitsets for graphs with more than
+    * RA_DENSE_GRAPH_MAX_NODES nodes, or NULL.
+    */
+   struct hash_table_u64 *edges;
+
    ra_select_reg_callback select_reg_callback;
    void *select_reg_callback_data;
 
@@ -484,10 +500,26 @@ ra_set_deserialize(void *mem_ctx, struct blob_reader *blob)
    return regs;
 }
 
+static uint64_t
+ra_edge_key(unsigned int n1, unsigned int n2)
+{
+   return n1 < n2 ? ((uint64_t)n1 << 32) | n2 : ((uint64_t)n2 << 32) | n1;
+}
+
+static bool
+ra_nodes_interfere(struct ra_graph *g, unsigned int n1, unsigned int n2)
+{
+   if (g->edges)
+      return _mesa_hash_table_u64_search(g->edges, ra_edge_key(n1, n2));
+
+   return BITSET_TEST(g->nodes[n1].adjacency, n2);
+}
+
 static void
 ra_add_node_adjacency(struct ra_graph *g, unsigned int n1, unsigned int n2)
 {
-   BITSET_SET(g->nodes[n1].adjacency, n2);
+   if (!g->edges)
+      BITSET_SET(g->nodes[n1].adjacency, n2);
 
    assert(n1 != n2);
 
@@ -501,7 +533,10 @@ ra_add_node_adjacency(struct ra_graph *g, unsigned int n1, unsigned int n2)
 static void
 ra_node_remove_adjacency(struct ra_graph *g, unsigned int n1, unsigned int n2)
 {
-   BITSET_CLEAR(g->nodes[n1].adjacency, n2);
+   if (g->edges)
+      _mesa_hash_table_u64_remove(g->edges, ra_edge_key(n1, n2));
+   else
+      BITSET_CLEAR(g->nodes[n1].adjacency, n2);
 
    assert(n1 != n2);
 
@@ -529,17 +564,40 @@ ra_realloc_interference_graph(struct ra_graph *g, unsigned int alloc)
 
    unsigned g_bitset_count = BITSET_WORDS(g->alloc);
    unsigned bitset_count = BITSET_WORDS(alloc);
-   /* For nodes already in the graph, we just have to grow the adjacency set */
-   for (unsigned i = 0; i < g->alloc; i++) {
-      assert(g->nodes[i].adjacency != NULL);
-      g->nodes[i].adjacency = rerzalloc(g, g->nodes[i].adjacency, BITSET_WORD,
-                                        g_bitset_count, bitset_count);
+
+   if (!g->edges && alloc > RA_DENSE_GRAPH_MAX_NODES) {
+      /* Move the existing edges from the bitsets to the edge set, which
+       * only needs the adjacency lists.
+       */
+      /* Not a child of g, ra_graph_destructor() frees it as a whole. */
+      g->edges = _mesa_hash_table_u64_create(NULL);
+      _mesa_hash_table_enable_group_probing(g->edges->table);
+
+      for (unsigned i = 0; i < g->alloc; i++) {
+         util_dynarray_foreach(&g->nodes[i].adjacency_list, unsigned int, n2p) {
+            if (i < *n2p)
+               _mesa_hash_table_u64_insert(g->edges, ra_edge_key(i, *n2p), g);
+         }
+         ralloc_free(g->nodes[i].adjacency);
+         g->nodes[i].adjacency = NULL;
+      }
+   } else if (!g->edges) {
+      /* For nodes already in the graph, we just have to grow the adjacency
+       * set.
+       */
+      for (unsigned i = 0; i < g->alloc; i++) {
+         assert(g->nodes[i].adjacency != NULL);
+         g->nodes[i].adjacency = rerzalloc(g, g->nodes[i].adjacency,
+                                           BITSET_WORD,
+                                           g_bitset_count, bitset_count);
+      }
    }
 
    /* For new nodes, we have to fully initialize them */
    for (unsigned i = g->alloc; i < alloc; i++) {
       memset(&g->nodes[i], 0, sizeof(g->nodes[i]));
-      g->nodes[i].adjacency = rzalloc_array(g, BITSET_WORD, bitset_count);
+      if (!g->edges)
+         g->nodes[i].adjacency = rzalloc_array(g, BITSET_WORD, bitset_count);
       util_dynarray_init(&g->nodes[i].adjacency_list, g);
       g->nodes[i].q_total = 0;
 
@@ -564,12 +622,21 @@ ra_realloc_interference_graph(struct ra_graph *g, unsigned int alloc)
    g->alloc = alloc;
 }
 
+static void
+ra_graph_destructor(void *ptr)
+{
+   struct ra_graph *g = ptr;
+
+   _mesa_hash_table_u64_destroy(g->edges, NULL);
+}
+
 struct ra_graph *
 ra_alloc_interference_graph(struct ra_regs *regs, unsigned int count)
 {
    struct ra_graph *g;
 
-   g = rzalloc(NULL, struct ra_graph);
+   g = rzalloc_size_with_destructor(NULL, sizeof(struct ra_graph),
+                                    ra_graph_destructor);
    g->regs = regs;
    g->count = count;
    ra_realloc_interference_graph(g, count);
@@ -623,7 +690,9 @@ ra_add_node_interference(struct ra_graph *g,
                          unsigned int n1, unsigned int n2)
 {
    assert(n1 < g->count && n2 < g->count);
-   if (n1 != n2 && !BITSET_TEST(g->nodes[n1].adjacency, n2)) {
+   if (n1 != n2 && !ra_nodes_interfere(g, n1, n2)) {
+      if (g->edges)
+         _mesa_hash_table_u64_insert(g->edges, ra_edge_key(n1, n2), g);
       ra_add_node_adjacency(g, n1, n2);
       ra_add_node_adjacency(g, n2, n1);
    }
@@ -636,8 +705,10 @@ ra_reset_node_interference(struct ra_graph *g, unsigned int n)
       ra_node_remove_adjacency(g, *n2p, n);
    }
 
-   memset(g->nodes[n].adjacency, 0,
-          BITSET_WORDS(g->count) * sizeof(BITSET_WORD));
+   if (!g->edges) {
+      memset(g->nodes[n].adjacency, 0,
+             BITSET_WORDS(g->count) * sizeof(BITSET_WORD));
+   }
    util_dynarray_clear(&g->nodes[n].adjacency_list);
 }
 
@@ -802,21 +873,6 @@ ra_simplify(struct ra_graph *g)
    g->tmp.stack_optimistic_start = stack_optimistic_start;
 }
 
-static bool
-ra_any_neighbors_conflict(struct ra_graph *g, unsigned int n, unsigned int r)
-{
-   util_dynarray_foreach(&g->nodes[n].adjacency_list, unsigned int, n2p) {
-      unsigned int n2 = *n2p;
-
-      if (!BITSET_TEST(g->tmp.in_stack, n2) &&
-          BITSET_TEST(g->regs->regs[r].conflicts, g->nodes[n2].reg)) {
-         return true;
-      }
-   }
-
-   return false;
-}
-
 /* Computes a bitfield of what regs are available for a given register
  * selection.
  *
@@ -852,6 +908,30 @@ ra_compute_available_regs(struct ra_graph *g, unsigned int n, BITSET_WORD *regs)
    return false;
 }
 
+/**
+ * Returns the first register set in regs, starting the search at start and
+ * wrapping around, or count if there is none.
+ */
+static unsigned int
+ra_find_available_reg(const BITSET_WORD *regs, unsigned int count,
+                      unsigned int start)
+{
+   unsigned int words = BITSET_WORDS(count);
+   unsigned int w = start / BITSET_WORDBITS;
+   BITSET_WORD mask = regs[w] & (~(BITSET_WORD)0 << (start % BITSET_WORDBITS));
+
+   /* The first word is visited twice, for the bits above and below start. */
+   for (unsigned int i = 0; i <= words; i++) {
+      if (mask)
+         return w * BITSET_WORDBITS + ffs(mask) - 1;
+
+      w = (w + 1) % words;
+      mask = regs[w];
+   }
+
+   return count;
+}
+
 /**
  * Pops nodes from the stack back into the graph, coloring them with
  * registers as they go.
@@ -863,46 +943,35 @@ static bool
 ra_select(struct ra_graph *g)
 {
    int start_search_reg = 0;
-   BITSET_WORD *select_regs = NULL;
-
-   if (g->select_reg_callback)
-      select_regs = malloc(BITSET_WORDS(g->regs->count) * sizeof(BITSET_WORD));
+   BITSET_WORD *select_regs =
+      malloc(BITSET_WORDS(g->regs->count) * sizeof(BITSET_WORD));
 
    while (g->tmp.stack_count != 0) {
-      unsigned int ri;
       unsigned int r = -1;
       int n = g->tmp.stack[g->tmp.stack_count - 1];
-      struct ra_class *c = g->regs->classes[g->nodes[n].class];
 
       /* set this to false even if we return here so that
        * ra_get_best_spill_node() considers this node later.
        */
       BITSET_CLEAR(g->tmp.in_stack, n);
 
-      if (g->select_reg_callback) {
-         if (!ra_compute_available_regs(g, n, select_regs)) {
-            free(select_regs);
-            return false;
-         }
+      if (!ra_compute_available_regs(g, n, select_regs)) {
+         free(select_regs);
+         return false;
+      }
 
+      if (g->select_reg_callback) {
          r = g->select_reg_callback(n, select_regs, g->select_reg_callback_data);
-         assert(r < g->regs->count);
       } else {
          /* Find the lowest-numbered reg which is not used by a member
-          * of the graph adjacent to us.
+          * of the graph adjacent to us.  Computing the available set once
+          * is much cheaper than checking every register of the class
+          * against all the neighbors.
           */
-         for (ri = 0; ri < g->regs->count; ri++) {
-            r = (start_search_reg + ri) % g->regs->count;
-            if (!reg_belongs_to_class(r, c))
-               continue;
-
-            if (!ra_any_neighbors_conflict(g, n, r))
-               break;
-         }
-
-         if (ri >= g->regs->count)
-            return false;
+         r = ra_find_available_reg(select_regs, g->regs->count,
+                                   start_search_reg % g->regs->count);
       }
+      assert(r < g->regs->count);
 
       g->nodes[n].reg = r;
       g->tmp.stack_count--;
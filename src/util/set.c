@@ -37,6 +37,8 @@
 #include <string.h>
 
 #include "hash_table.h"
+#include "hash_table_group.h"
+#include "bitscan.h"
 #include "macros.h"
 #include "ralloc.h"
 #include "set.h"
@@ -139,6 +141,7 @@ _mesa_set_create(void *mem_ctx,
    ht->table = rzalloc_array(ht, struct set_entry, ht->size);
    ht->entries = 0;
    ht->deleted_entries = 0;
+   ht->ctrl = NULL;
 
    if (ht->table == NULL) {
       ralloc_free(ht);
@@ -167,6 +170,15 @@ _mesa_set_clone(struct set *set, void *dst_mem_ctx)
 
    memcpy(clone->table, set->table, clone->size * sizeof(struct set_entry));
 
+   if (set->ctrl) {
+      clone->ctrl = ralloc_array(clone->table, uint8_t, clone->size);
+      if (clone->ctrl == NULL) {
+         ralloc_free(clone);
+         return NULL;
+      }
+      memcpy(clone->ctrl, set->ctrl, clone->size);
+   }
+
    return clone;
 }
 
@@ -209,19 +221,112 @@ _mesa_set_clear(struct set *set, void (*delete_function)(struct set_entry *entry
       entry->key = deleted_key;
    }
 
+   if (set->ctrl) {
+      memset(set->table, 0, set->size * sizeof(struct set_entry));
+      memset(set->ctrl, HASH_CTRL_EMPTY, set->size);
+   }
+
    set->entries = set->deleted_entries = 0;
 }
 
+/**
+ * Allocates the entries and control bytes of a group-probed set with
+ * 2^size_index groups.  The control bytes are a child of the entry array, so
+ * that freeing the entries frees both.
+ */
+static bool
+set_alloc_grouped(struct set *ht, unsigned size_index)
+{
+   uint32_t size = HASH_GROUP_SIZE << size_index;
+   struct set_entry *table;
+   uint8_t *ctrl;
+
+   table = rzalloc_array(ht, struct set_entry, size);
+   if (table == NULL)
+      return false;
+
+   ctrl = ralloc_array(table, uint8_t, size);
+   if (ctrl == NULL) {
+      ralloc_free(table);
+      return false;
+   }
+   memset(ctrl, HASH_CTRL_EMPTY, size);
+
+   ht->table = table;
+   ht->ctrl = ctrl;
+   ht->size_index = size_index;
+   ht->size = size;
+   ht->rehash = 0;
+   ht->size_magic = 0;
+   ht->rehash_magic = 0;
+   ht->max_entries = size - size / 8;
+   ht->entries = 0;
+   ht->deleted_entries = 0;
+
+   return true;
+}
+
+/**
+ * Switches an empty set to group probing, see
+ * _mesa_hash_table_enable_group_probing().
+ *
+ * Returns false if the allocation failed, leaving the set unchanged.
+ */
+bool
+_mesa_set_enable_group_probing(struct set *set)
+{
+   struct set_entry *old_table = set->table;
+
+   assert(set->entries == 0 && set->deleted_entries == 0);
+
+   if (!set_alloc_grouped(set, 0))
+      return false;
+
+   ralloc_free(old_table);
+   return true;
+}
+
 /**
  * Finds a set entry with the given key and hash of that key.
  *
  * Returns NULL if no entry is found.
  */
+static struct set_entry *
+set_search_grouped(const struct set *ht, uint32_t hash, const void *key)
+{
+   uint32_t group_mask = (ht->size / HASH_GROUP_SIZE) - 1;
+   uint32_t group = hash_group_start(hash, ht->size_index);
+   uint8_t tag = hash_group_tag(hash);
+
+   for (uint32_t i = 1; i <= group_mask + 1; i++) {
+      const uint8_t *ctrl = ht->ctrl + group * HASH_GROUP_SIZE;
+      struct set_entry *group_entries = ht->table + group * HASH_GROUP_SIZE;
+      unsigned match = hash_group_match(ctrl, tag);
+
+      while (match) {
+         struct set_entry *entry = group_entries + u_bit_scan(&match);
+
+         if (entry->hash == hash && ht->key_equals_function(key, entry->key))
+            return entry;
+      }
+
+      if (hash_group_match_empty(ctrl))
+         return NULL;
+
+      group = (group + i) & group_mask;
+   }
+
+   return NULL;
+}
+
 static struct set_entry *
 set_search(const struct set *ht, uint32_t hash, const void *key)
 {
    assert(!key_pointer_is_reserved(key));
 
+   if (ht->ctrl)
+      return set_search_grouped(ht, hash, key);
+
    uint32_t size = ht->size;
    uint32_t start_address = util_fast_urem32(hash, size, ht->size_magic);
    uint32_t double_hash = util_fast_urem32(hash, ht->rehash,
@@ -262,9 +367,41 @@ _mesa_set_search_pre_hashed(const struct set *set, uint32_t hash,
    return set_search(set, hash, key);
 }
 
+/**
+ * Returns the first slot available for a new entry with the given hash,
+ * or -1 if the set is full.
+ */
+static int
+set_find_available_grouped(const struct set *ht, uint32_t hash)
+{
+   uint32_t group_mask = (ht->size / HASH_GROUP_SIZE) - 1;
+   uint32_t group = hash_group_start(hash, ht->size_index);
+
+   for (uint32_t i = 1; i <= group_mask + 1; i++) {
+      unsigned available =
+         hash_group_match_available(ht->ctrl + group * HASH_GROUP_SIZE);
+
+      if (available)
+         return group * HASH_GROUP_SIZE + ffs(available) - 1;
+
+      group = (group + i) & group_mask;
+   }
+
+   return -1;
+}
+
 static void
 set_add_rehash(struct set *ht, uint32_t hash, const void *key)
 {
+   if (ht->ctrl) {
+      int i = set_find_available_grouped(ht, hash);
+      assert(i >= 0);
+      ht->ctrl[i] = hash_group_tag(hash);
+      ht->table[i].hash = hash;
+      ht->table[i].key = key;
+      return;
+   }
+
    uint32_t size = ht->size;
    uint32_t start_address = util_fast_urem32(hash, size, ht->size_magic);
    uint32_t double_hash = util_fast_urem32(hash, ht->rehash,
@@ -290,6 +427,24 @@ set_rehash(struct set *ht, unsigned new_size_index)
    struct set old_ht;
    struct set_entry *table;
 
+   if (ht->ctrl) {
+      if (new_size_index > HASH_GROUP_MAX_SIZE_INDEX)
+         return;
+
+      old_ht = *ht;
+      if (!set_alloc_grouped(ht, new_size_index))
+         return;
+
+      set_foreach(&old_ht, entry) {
+         set_add_rehash(ht, entry->hash, entry->key);
+      }
+
+      ht->entries = old_ht.entries;
+
+      ralloc_free(old_ht.table);
+      return;
+   }
+
    if (new_size_index >= ARRAY_SIZE(hash_sizes))
       return;
 
@@ -327,12 +482,71 @@ _mesa_set_resize(struct set *set, uint32_t entries)
       entries = set->entries;
 
    unsigned size_index = 0;
-   while (hash_sizes[size_index].max_entries < entries)
-      size_index++;
+   if (set->ctrl) {
+      while ((HASH_GROUP_SIZE << size_index) / 8 * 7 < entries)
+         size_index++;
+   } else {
+      while (hash_sizes[size_index].max_entries < entries)
+         size_index++;
+   }
 
    set_rehash(set, size_index);
 }
 
+static struct set_entry *
+set_search_or_add_grouped(struct set *ht, uint32_t hash, const void *key,
+                          bool *found)
+{
+   uint32_t group_mask = (ht->size / HASH_GROUP_SIZE) - 1;
+   uint32_t group = hash_group_start(hash, ht->size_index);
+   uint8_t tag = hash_group_tag(hash);
+   int available = -1;
+
+   for (uint32_t i = 1; i <= group_mask + 1; i++) {
+      const uint8_t *ctrl = ht->ctrl + group * HASH_GROUP_SIZE;
+      struct set_entry *group_entries = ht->table + group * HASH_GROUP_SIZE;
+      unsigned match = hash_group_match(ctrl, tag);
+
+      while (match) {
+         struct set_entry *entry = group_entries + u_bit_scan(&match);
+
+         if (entry->hash == hash && ht->key_equals_function(key, entry->key)) {
+            if (found)
+               *found = true;
+            return entry;
+         }
+      }
+
+      /* Stash the first available slot we find */
+      if (available < 0) {
+         unsigned mask = hash_group_match_available(ctrl);
+         if (mask)
+            available = group * HASH_GROUP_SIZE + ffs(mask) - 1;
+      }
+
+      if (hash_group_match_empty(ctrl))
+         break;
+
+      group = (group + i) & group_mask;
+   }
+
+   if (available < 0) {
+      /* We could hit here if a required resize failed. */
+      return NULL;
+   }
+
+   /* There is no matching entry, create it. */
+   if (ht->ctrl[available] == HASH_CTRL_DELETED)
+      ht->deleted_entries--;
+   ht->ctrl[available] = tag;
+   ht->table[available].hash = hash;
+   ht->table[available].key = key;
+   ht->entries++;
+   if (found)
+      *found = false;
+   return &ht->table[available];
+}
+
 /**
  * Find a matching entry for the given key, or insert it if it doesn't already
  * exist.
@@ -353,6 +567,9 @@ set_search_or_add(struct set *ht, uint32_t hash, const void *key, bool *found)
       set_rehash(ht, ht->size_index);
    }
 
+   if (ht->ctrl)
+      return set_search_or_add_grouped(ht, hash, key, found);
+
    uint32_t size = ht->size;
    uint32_t start_address = util_fast_urem32(hash, size, ht->size_magic);
    uint32_t double_hash = util_fast_urem32(hash, ht->rehash,
@@ -498,6 +715,8 @@ _mesa_set_remove(struct set *ht, struct set_entry *entry)
       return;
 
    entry->key = deleted_key;
+   if (ht->ctrl)
+      ht->ctrl[entry - ht->table] = HASH_CTRL_DELETED;
    ht->entries--;
    ht->deleted_entries++;
 }
@@ -53,6 +53,8 @@ struct set {
    uint32_t size_index;
    uint32_t entries;
    uint32_t deleted_entries;
+   /* Control bytes of a group-probed set, NULL for double hashing. */
+   uint8_t *ctrl;
 };
 
 struct set *
@@ -68,6 +70,8 @@ _mesa_set_destroy(struct set *set,
                   void (*delete_function)(struct set_entry *entry));
 void
 _mesa_set_resize(struct set *set, uint32_t entries);
+bool
+_mesa_set_enable_group_probing(struct set *set);
 void
 _mesa_set_clear(struct set *set,
                 void (*delete_function)(struct set_entry *entry));
@@ -79,6 +79,15 @@ void util_sparse_array_finish(struct util_sparse_array *arr);
 
 void *util_sparse_array_get(struct util_sparse_array *arr, uint64_t idx);
 
+/** Like util_sparse_array_get() but never allocates
+ *
+ * Returns NULL if the node which would contain idx hasn't been allocated
+ * yet.  This makes it suitable for lock-free lookups of indices which may
+ * never have been written.
+ */
+void *util_sparse_array_get_if_present(struct util_sparse_array *arr,
+                                       uint64_t idx);
+
 void util_sparse_array_validate(struct util_sparse_array *arr);
 
 /** A thread-safe free list for use with struct util_sparse_array
@@ -29,8 +29,13 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <float.h>
+#include <math.h>
+#include <string.h>
 
+#include "util/os_time.h"
+#include "util/u_cpu_detect.h"
 #include "util/u_half.h"
+#include "util/u_memory.h"
 #include "util/format/u_format.h"
 #include "util/format/u_format_tests.h"
 #include "util/format/u_format_s3tc.h"
@@ -841,11 +846,202 @@ test_all(void)
 }
 
 
+#define ROWS_WIDTH  67
+#define ROWS_HEIGHT 3
+
+static unsigned rows_seed = 1;
+
+static void
+fill_random(void *data, unsigned size)
+{
+   uint8_t *bytes = data;
+
+   for (unsigned i = 0; i < size; i++) {
+      rows_seed = rows_seed * 1103515245 + 12345;
+      bytes[i] = rows_seed >> 16;
+   }
+}
+
+static void
+fill_random_float(float *data, unsigned count)
+{
+   for (unsigned i = 0; i < count; i++) {
+      rows_seed = rows_seed * 1103515245 + 12345;
+      /* Mostly in [-0.25, 1.25], with some NaN and infinities. */
+      switch ((rows_seed >> 16) % 64) {
+      case 0:
+         data[i] = NAN;
+         break;
+      case 1:
+         data[i] = INFINITY;
+         break;
+      case 2:
+         data[i] = -INFINITY;
+         break;
+      default:
+         data[i] = (rows_seed >> 8) * (1.5f / (1 << 24)) - 0.25f;
+         break;
+      }
+   }
+}
+
+/**
+ * Checks that the functions the tables return for the detected CPU give the
+ * same results as the generic ones, over rows that are not a multiple of
+ * any vector width.
+ */
+static boolean
+test_cpu_specific_rows(void)
+{
+   struct util_cpu_caps caps = util_cpu_caps;
+   boolean success = TRUE;
+   unsigned float_stride = ROWS_WIDTH * 4 * sizeof(float);
+   unsigned byte_stride = ROWS_WIDTH * 4;
+   unsigned packed_stride = ROWS_WIDTH * UTIL_FORMAT_MAX_PACKED_BYTES;
+   float *floats = MALLOC(ROWS_HEIGHT * float_stride);
+   uint8_t *bytes = MALLOC(ROWS_HEIGHT * byte_stride);
+   uint8_t *packed = MALLOC(ROWS_HEIGHT * packed_stride);
+   unsigned out_size = ROWS_HEIGHT * MAX2(float_stride, packed_stride);
+   uint8_t *ref = MALLOC(out_size);
+   uint8_t *out = MALLOC(out_size);
+
+   for (enum pipe_format format = 1; format < PIPE_FORMAT_COUNT; ++format) {
+      const struct util_format_description *desc = util_format_description(format);
+      const struct util_format_pack_description *pack, *generic_pack;
+      const struct util_format_unpack_description *unpack, *generic_unpack;
+
+      if (!desc || desc->block.width != 1 || desc->block.height != 1)
+         continue;
+
+      pack = util_format_pack_description(format);
+      unpack = util_format_unpack_description(format);
+      memset(&util_cpu_caps, 0, sizeof(util_cpu_caps));
+      generic_pack = util_format_pack_description(format);
+      generic_unpack = util_format_unpack_description(format);
+      util_cpu_caps = caps;
+
+      fill_random(packed, ROWS_HEIGHT * packed_stride);
+      fill_random(bytes, ROWS_HEIGHT * byte_stride);
+      fill_random_float(floats, ROWS_HEIGHT * float_stride / sizeof(float));
+
+#     define COMPARE_ROWS(table, name, dst_stride, src, src_stride) \
+      if (table->name != generic_##table->name) { \
+         printf("Testing util_format_%s_%s rows ...\n", desc->short_name, #name); \
+         memset(ref, 0, ROWS_HEIGHT * dst_stride); \
+         memset(out, 0, ROWS_HEIGHT * dst_stride); \
+         generic_##table->name((void *)ref, dst_stride, src, src_stride, \
+                               ROWS_WIDTH, ROWS_HEIGHT); \
+         table->name((void *)out, dst_stride, src, src_stride, \
+                     ROWS_WIDTH, ROWS_HEIGHT); \
+         if (memcmp(ref, out, ROWS_HEIGHT * dst_stride) != 0) { \
+            printf("FAILED: util_format_%s_%s differs from the generic function\n", \
+                   desc->short_name, #name); \
+            success = FALSE; \
+         } \
+      }
+
+      COMPARE_ROWS(unpack, unpack_rgba, float_stride, packed, packed_stride);
+      COMPARE_ROWS(unpack, unpack_rgba_8unorm, byte_stride, packed, packed_stride);
+      COMPARE_ROWS(pack, pack_rgba_float, packed_stride, floats, float_stride);
+      COMPARE_ROWS(pack, pack_rgba_8unorm, packed_stride, bytes, byte_stride);
+
+#     undef COMPARE_ROWS
+   }
+
+   FREE(floats);
+   FREE(bytes);
+   FREE(packed);
+   FREE(ref);
+   FREE(out);
+
+   return success;
+}
+
+
+#define BENCH_WIDTH  512
+#define BENCH_HEIGHT 512
+#define BENCH_LOOPS  8
+
+/**
+ * Prints the speed of the row functions of every format, in megapixels per
+ * second, for the functions the tables return on this CPU.
+ */
+static void
+benchmark_all(void)
+{
+   unsigned float_stride = BENCH_WIDTH * 4 * sizeof(float);
+   unsigned byte_stride = BENCH_WIDTH * 4;
+   unsigned packed_stride = BENCH_WIDTH * UTIL_FORMAT_MAX_PACKED_BYTES;
+   float *floats = MALLOC(BENCH_HEIGHT * float_stride);
+   uint8_t *bytes = MALLOC(BENCH_HEIGHT * byte_stride);
+   uint8_t *packed = MALLOC(BENCH_HEIGHT * packed_stride);
+
+   fill_random(packed, BENCH_HEIGHT * packed_stride);
+   fill_random(bytes, BENCH_HEIGHT * byte_stride);
+   fill_random_float(floats, BENCH_HEIGHT * float_stride / sizeof(float));
+
+   printf("%-40s %12s %12s %12s %12s\n", "Mpixel/s", "unpack_rgba",
+          "unpack_8unorm", "pack_float", "pack_8unorm");
+
+   for (enum pipe_format format = 1; format < PIPE_FORMAT_COUNT; ++format) {
+      const struct util_format_description *desc = util_format_description(format);
+      const struct util_format_pack_description *pack;
+      const struct util_format_unpack_description *unpack;
+      unsigned width, height;
+
+      if (!desc)
+         continue;
+
+      pack = util_format_pack_description(format);
+      unpack = util_format_unpack_description(format);
+      if (!pack || !unpack || !unpack->unpack_rgba)
+         continue;
+
+      width = BENCH_WIDTH / desc->block.width * desc->block.width;
+      height = BENCH_HEIGHT / desc->block.height * desc->block.height;
+
+      printf("%-40s", desc->short_name);
+
+#     define BENCH_ROWS(table, name, dst, dst_stride, src, src_stride) \
+      if (table->name) { \
+         int64_t start = os_time_get_nano(); \
+         for (unsigned i = 0; i < BENCH_LOOPS; i++) \
+            table->name((void *)dst, dst_stride, src, src_stride, width, height); \
+         double secs = (os_time_get_nano() - start) / 1000000000.0; \
+         printf(" %12.1f", BENCH_LOOPS * width * height / secs / 1000000.0); \
+      } else { \
+         printf(" %12s", "-"); \
+      }
+
+      BENCH_ROWS(unpack, unpack_rgba, floats, float_stride, packed, packed_stride);
+      BENCH_ROWS(unpack, unpack_rgba_8unorm, bytes, byte_stride, packed, packed_stride);
+      BENCH_ROWS(pack, pack_rgba_float, packed, packed_stride, floats, float_stride);
+      BENCH_ROWS(pack, pack_rgba_8unorm, packed, packed_stride, bytes, byte_stride);
+
+#     undef BENCH_ROWS
+
+      printf("\n");
+   }
+
+   FREE(floats);
+   FREE(bytes);
+   FREE(packed);
+}
+
+
 int main(int argc, char **argv)
 {
    boolean success;
 
+   util_cpu_detect();
+
+   if (argc > 1 && strcmp(argv[1], "--benchmark") == 0) {
+      benchmark_all();
+      return 0;
+   }
+
    success = test_all();
+   success &= test_cpu_specific_rows();
 
    return success ? 0 : 1;
 }
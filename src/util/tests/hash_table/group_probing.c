@@ -0,0 +1,150 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Checks a group-probed table against a default one over a random sequence
+ * of inserts, removals and lookups. With --benchmark, only times both layouts
+ * on pointer keys instead.
+ */
+
+#undef NDEBUG
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "hash_table.h"
+#include "os_time.h"
+
+#define NUM_KEYS 4096
+#define NUM_OPS  200000
+#define BENCH_KEYS (1 << 16)
+#define BENCH_ROUNDS 32
+
+static uint32_t keys[NUM_KEYS];
+
+static void
+check_same(struct hash_table *a, struct hash_table *b)
+{
+   assert(_mesa_hash_table_num_entries(a) == _mesa_hash_table_num_entries(b));
+
+   hash_table_foreach(a, entry) {
+      struct hash_entry *other = _mesa_hash_table_search(b, entry->key);
+      assert(other && other->data == entry->data);
+   }
+}
+
+static double
+bench(bool group_probing)
+{
+   struct hash_table *ht = _mesa_pointer_hash_table_create(NULL);
+   uint32_t *storage = malloc(2 * BENCH_KEYS * sizeof(uint32_t));
+   unsigned found = 0;
+
+   if (group_probing)
+      _mesa_hash_table_enable_group_probing(ht);
+
+   int64_t start = os_time_get_nano();
+
+   for (unsigned i = 0; i < BENCH_KEYS; i++)
+      _mesa_hash_table_insert(ht, &storage[i], NULL);
+
+   /* Half of the lookups hit, half miss. */
+   for (unsigned r = 0; r < BENCH_ROUNDS; r++) {
+      for (unsigned i = 0; i < 2 * BENCH_KEYS; i++)
+         found += _mesa_hash_table_search(ht, &storage[i]) != NULL;
+   }
+
+   int64_t elapsed = os_time_get_nano() - start;
+
+   assert(found == BENCH_ROUNDS * BENCH_KEYS);
+
+   _mesa_hash_table_destroy(ht, NULL);
+   free(storage);
+
+   return elapsed / 1000000.0;
+}
+
+int
+main(int argc, char **argv)
+{
+   struct hash_table *ref, *ht, *clone;
+   unsigned seed = 1;
+
+   if (argc > 1 && strcmp(argv[1], "--benchmark") == 0) {
+      printf("double hashing: %.1f ms\n", bench(false));
+      printf("group probing:  %.1f ms\n", bench(true));
+      return 0;
+   }
+
+   for (unsigned i = 0; i < NUM_KEYS; i++)
+      keys[i] = i;
+
+   ref = _mesa_hash_table_create(NULL, _mesa_hash_u32, _mesa_key_u32_equal);
+   ht = _mesa_hash_table_create(NULL, _mesa_hash_u32, _mesa_key_u32_equal);
+   assert(_mesa_hash_table_enable_group_probing(ht));
+
+   for (unsigned i = 0; i < NUM_OPS; i++) {
+      seed = seed * 1103515245 + 12345;
+      uint32_t *key = &keys[(seed >> 8) % NUM_KEYS];
+      void *data = (void *)(uintptr_t)(i + 1);
+
+      switch ((seed >> 24) % 3) {
+      case 0:
+         _mesa_hash_table_insert(ref, key, data);
+         _mesa_hash_table_insert(ht, key, data);
+         break;
+      case 1:
+         _mesa_hash_table_remove_key(ref, key);
+         _mesa_hash_table_remove_key(ht, key);
+         break;
+      default: {
+         struct hash_entry *a = _mesa_hash_table_search(ref, key);
+         struct hash_entry *b = _mesa_hash_table_search(ht, key);
+         assert((a == NULL) == (b == NULL));
+         assert(!a || a->data == b->data);
+         break;
+      }
+      }
+
+      if (i % 10000 == 0) {
+         check_same(ref, ht);
+         check_same(ht, ref);
+      }
+   }
+
+   clone = _mesa_hash_table_clone(ht, NULL);
+   check_same(ref, clone);
+   check_same(clone, ref);
+   _mesa_hash_table_destroy(clone, NULL);
+
+   _mesa_hash_table_clear(ht, NULL);
+   assert(_mesa_hash_table_num_entries(ht) == 0);
+   assert(_mesa_hash_table_next_entry(ht, NULL) == NULL);
+   for (unsigned i = 0; i < NUM_KEYS; i++)
+      assert(_mesa_hash_table_search(ht, &keys[i]) == NULL);
+
+   _mesa_hash_table_destroy(ref, NULL);
+   _mesa_hash_table_destroy(ht, NULL);
+
+   return 0;
+}
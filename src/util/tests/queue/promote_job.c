@@ -0,0 +1,137 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Checks the execution order that util_queue_promote_job guarantees on a
+ * single-threaded queue.
+ */
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdio.h>
+
+#include "util/u_queue.h"
+
+#define NUM_JOBS 5
+#define MAX_JOBS 8
+
+struct test_job {
+   unsigned id;
+   struct util_queue_fence fence;
+};
+
+static struct util_queue_fence blocker_started;
+static struct util_queue_fence blocker_gate;
+
+static unsigned order[NUM_JOBS + 1];
+static unsigned num_executed;
+
+static void
+blocker_execute(void *data, int thread_index)
+{
+   util_queue_fence_signal(&blocker_started);
+   util_queue_fence_wait(&blocker_gate);
+   order[num_executed++] = 0;
+}
+
+static void
+job_execute(void *data, int thread_index)
+{
+   struct test_job *job = data;
+
+   order[num_executed++] = job->id;
+}
+
+/* Queues a job that blocks the only thread, then jobs 1 to NUM_JOBS behind
+ * it, and promotes jobs 4 and 2 while they are all still queued.
+ */
+static void
+run(struct util_queue *queue)
+{
+   static const unsigned expected[NUM_JOBS + 1] = { 0, 2, 4, 1, 3, 5 };
+   struct util_queue_fence blocker_fence;
+   struct test_job blocker = { 0 };
+   struct test_job jobs[NUM_JOBS];
+
+   util_queue_fence_init(&blocker_fence);
+   util_queue_fence_init(&blocker_started);
+   util_queue_fence_init(&blocker_gate);
+   util_queue_fence_reset(&blocker_started);
+   util_queue_fence_reset(&blocker_gate);
+   num_executed = 0;
+
+   util_queue_add_job(queue, &blocker, &blocker_fence, blocker_execute,
+                      NULL, 0);
+   util_queue_fence_wait(&blocker_started);
+
+   for (unsigned i = 0; i < NUM_JOBS; i++) {
+      jobs[i].id = i + 1;
+      util_queue_fence_init(&jobs[i].fence);
+      util_queue_add_job(queue, &jobs[i], &jobs[i].fence, job_execute,
+                         NULL, 0);
+   }
+
+   util_queue_promote_job(queue, &jobs[3].fence);
+   util_queue_promote_job(queue, &jobs[1].fence);
+   /* The running job isn't in the ring anymore, so this does nothing. */
+   util_queue_promote_job(queue, &blocker_fence);
+
+   util_queue_fence_signal(&blocker_gate);
+   util_queue_finish(queue);
+
+   assert(num_executed == NUM_JOBS + 1);
+   for (unsigned i = 0; i <= NUM_JOBS; i++) {
+      if (order[i] != expected[i]) {
+         printf("job %u ran at position %u, expected job %u\n",
+                order[i], i, expected[i]);
+         assert(0);
+      }
+   }
+
+   /* Promoting a job that is done does nothing. */
+   util_queue_promote_job(queue, &jobs[0].fence);
+
+   for (unsigned i = 0; i < NUM_JOBS; i++)
+      util_queue_fence_destroy(&jobs[i].fence);
+   util_queue_fence_destroy(&blocker_fence);
+   util_queue_fence_destroy(&blocker_started);
+   util_queue_fence_destroy(&blocker_gate);
+}
+
+int
+main(int argc, char **argv)
+{
+   struct util_queue queue;
+
+   assert(util_queue_init(&queue, "promote", MAX_JOBS, 1, 0));
+
+   /* Each run uses 7 slots of the ring, including the barrier job of
+    * util_queue_finish, so the runs start at every offset and the queued
+    * jobs wrap around the end of the ring in some of them.
+    */
+   for (unsigned i = 0; i < MAX_JOBS; i++)
+      run(&queue);
+
+   util_queue_destroy(&queue);
+   return 0;
+}
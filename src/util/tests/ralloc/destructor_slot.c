@@ -0,0 +1,204 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+/* Checks that blocks allocated with ralloc_size_with_destructor() keep their
+ * destructor slot through ralloc_steal(), ralloc_adopt() and reralloc, and
+ * that the slot tag never leaks into the parent pointer.
+ */
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "util/ralloc.h"
+
+#define MAX_CALLS 16
+
+static int calls[MAX_CALLS];
+static unsigned num_calls;
+
+static void
+record_id(void *p)
+{
+   assert(num_calls < MAX_CALLS);
+   calls[num_calls++] = *(int *) p;
+}
+
+static void
+record_id_negated(void *p)
+{
+   assert(num_calls < MAX_CALLS);
+   calls[num_calls++] = -*(int *) p;
+}
+
+static int *
+alloc_with_id(void *ctx, int id)
+{
+   int *p = ralloc_size_with_destructor(ctx, sizeof(int), record_id);
+   *p = id;
+   return p;
+}
+
+static bool
+was_called(int id)
+{
+   for (unsigned i = 0; i < num_calls; i++) {
+      if (calls[i] == id)
+         return true;
+   }
+   return false;
+}
+
+static void
+test_steal(void)
+{
+   void *a = ralloc_context(NULL);
+   void *b = ralloc_context(NULL);
+   int *d = alloc_with_id(a, 1);
+   char *plain = ralloc_size(a, 16);
+
+   num_calls = 0;
+
+   /* A tagged block moves under a new parent, and a plain block moves
+    * under the tagged one.
+    */
+   ralloc_steal(b, d);
+   ralloc_steal(d, plain);
+   assert(ralloc_parent(d) == b);
+   assert(ralloc_parent(plain) == d);
+
+   ralloc_free(a);
+   assert(num_calls == 0);
+
+   ralloc_free(b);
+   assert(num_calls == 1 && calls[0] == 1);
+
+   /* Stealing to NULL keeps the tag as well. */
+   d = alloc_with_id(NULL, 2);
+   ralloc_steal(NULL, d);
+   assert(ralloc_parent(d) == NULL);
+   ralloc_free(d);
+   assert(num_calls == 2 && calls[1] == 2);
+}
+
+static void
+test_adopt(void)
+{
+   void *old_ctx = ralloc_context(NULL);
+   void *new_ctx = ralloc_context(NULL);
+   int *d1 = alloc_with_id(old_ctx, 1);
+   char *plain = ralloc_size(old_ctx, 16);
+   int *d2 = alloc_with_id(old_ctx, 2);
+   int *grandchild = alloc_with_id(d2, 3);
+   int *existing = alloc_with_id(new_ctx, 4);
+
+   num_calls = 0;
+
+   ralloc_adopt(new_ctx, old_ctx);
+   assert(ralloc_parent(d1) == new_ctx);
+   assert(ralloc_parent(plain) == new_ctx);
+   assert(ralloc_parent(d2) == new_ctx);
+   assert(ralloc_parent(grandchild) == d2);
+   assert(ralloc_parent(existing) == new_ctx);
+
+   ralloc_free(old_ctx);
+   assert(num_calls == 0);
+
+   ralloc_free(new_ctx);
+   assert(num_calls == 4);
+   assert(was_called(1) && was_called(2) && was_called(3) && was_called(4));
+}
+
+static void
+test_resize(void)
+{
+   void *ctx = ralloc_context(NULL);
+   int *d = alloc_with_id(ctx, 1);
+   int *child = alloc_with_id(d, 2);
+   char *plain_child = ralloc_size(d, 16);
+
+   num_calls = 0;
+
+   /* Big enough that realloc has to move the block, so the parent, sibling
+    * and child links all get rewritten.
+    */
+   d = reralloc_size(ctx, d, 1 << 20);
+   assert(d != NULL && *d == 1);
+   assert(ralloc_parent(d) == ctx);
+   assert(ralloc_parent(child) == d);
+   assert(ralloc_parent(plain_child) == d);
+
+   /* A resized plain parent must not tag or untag its children. */
+   char *plain = ralloc_size(ctx, 16);
+   int *under_plain = alloc_with_id(plain, 3);
+   plain = reralloc_size(ctx, plain, 1 << 20);
+   assert(ralloc_parent(under_plain) == plain);
+
+   d = reralloc_size(ctx, d, sizeof(int));
+   assert(*d == 1);
+
+   ralloc_free(d);
+   assert(num_calls == 2 && was_called(1) && was_called(2));
+
+   ralloc_free(ctx);
+   assert(num_calls == 3 && calls[2] == 3);
+}
+
+static void
+test_set_destructor(void)
+{
+   void *ctx = ralloc_context(NULL);
+   int *d = alloc_with_id(ctx, 5);
+   int *cleared = alloc_with_id(ctx, 6);
+   char *plain = ralloc_size(ctx, 16);
+
+   num_calls = 0;
+
+   ralloc_set_destructor(d, record_id_negated);
+   ralloc_set_destructor(cleared, NULL);
+   /* Clearing is allowed on any block. */
+   ralloc_set_destructor(plain, NULL);
+
+   ralloc_free(ctx);
+   assert(num_calls == 1 && calls[0] == -5);
+
+   int *z = rzalloc_size_with_destructor(NULL, sizeof(int), record_id);
+   assert(*z == 0);
+   *z = 7;
+   ralloc_free(z);
+   assert(num_calls == 2 && calls[1] == 7);
+}
+
+int
+main(void)
+{
+   test_steal();
+   test_adopt();
+   test_resize();
+   test_set_destructor();
+
+   return 0;
+}
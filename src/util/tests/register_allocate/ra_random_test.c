@@ -0,0 +1,264 @@
+/*
+ * Copyright © 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Random test and benchmark for the register allocator.
+ *
+ * Builds interference graphs from random live ranges over a register set of
+ * single registers and aligned pairs, which is round-tripped through
+ * ra_set_serialize() first.  Nodes are spilled the way drivers do it: the
+ * spilled node loses its interference and a short fill temporary is added
+ * with ra_add_node().  The resulting allocation is checked against the live
+ * ranges.  The default graph is a little smaller than
+ * RA_DENSE_GRAPH_MAX_NODES, so that the fill temporaries added while spilling
+ * move it from the dense to the sparse interference representation.
+ *
+ * With --benchmark, the time for building and coloring the graph is printed
+ * for a small graph and for one that starts out sparse.
+ */
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util/blob.h"
+#include "util/macros.h"
+#include "util/os_time.h"
+#include "util/ralloc.h"
+#include "util/register_allocate.h"
+
+#define NUM_REGS  64
+#define NUM_PAIRS (NUM_REGS / 2)
+#define MAX_LEN   80
+
+struct range {
+   unsigned start, end;
+   bool pair;
+   bool spilled;
+};
+
+static unsigned seed = 1;
+
+static unsigned
+rand_next(void)
+{
+   seed = seed * 1103515245 + 12345;
+   return seed >> 8;
+}
+
+static struct ra_regs *
+create_reg_set(void *mem_ctx, unsigned *single_class, unsigned *pair_class)
+{
+   struct ra_regs *regs = ra_alloc_reg_set(NULL, NUM_REGS + NUM_PAIRS, true);
+
+   *single_class = ra_alloc_reg_class(regs);
+   *pair_class = ra_alloc_reg_class(regs);
+
+   for (unsigned r = 0; r < NUM_REGS; r++)
+      ra_class_add_reg(regs, *single_class, r);
+
+   for (unsigned p = 0; p < NUM_PAIRS; p++) {
+      ra_class_add_reg(regs, *pair_class, NUM_REGS + p);
+      ra_add_transitive_reg_conflict(regs, 2 * p, NUM_REGS + p);
+      ra_add_transitive_reg_conflict(regs, 2 * p + 1, NUM_REGS + p);
+   }
+
+   ra_set_finalize(regs, NULL);
+
+   /* Allocate with a copy, the way drivers use cached register sets. */
+   struct blob blob;
+   struct blob_reader reader;
+
+   blob_init(&blob);
+   ra_set_serialize(regs, &blob);
+   ralloc_free(regs);
+
+   blob_reader_init(&reader, blob.data, blob.size);
+   regs = ra_set_deserialize(mem_ctx, &reader);
+   assert(!reader.overrun);
+   blob_finish(&blob);
+
+   return regs;
+}
+
+static unsigned
+first_hw_reg(unsigned reg)
+{
+   return reg < NUM_REGS ? reg : 2 * (reg - NUM_REGS);
+}
+
+static unsigned
+last_hw_reg(unsigned reg)
+{
+   return reg < NUM_REGS ? reg : 2 * (reg - NUM_REGS) + 1;
+}
+
+static bool
+ranges_overlap(const struct range *a, const struct range *b)
+{
+   return a->start < b->end && b->start < a->end;
+}
+
+/* Adds interference between node n and the nodes in [first, last) that
+ * overlap it.
+ */
+static void
+add_interference(struct ra_graph *g, const struct range *ranges,
+                 unsigned n, unsigned first, unsigned last)
+{
+   for (unsigned i = first; i < last; i++) {
+      if (i != n && !ranges[i].spilled &&
+          ranges_overlap(&ranges[n], &ranges[i]))
+         ra_add_node_interference(g, n, i);
+   }
+}
+
+static bool
+check_pair(struct ra_graph *g, const struct range *ranges,
+           unsigned a, unsigned b)
+{
+   if (a == b || ranges[a].spilled || ranges[b].spilled ||
+       !ranges_overlap(&ranges[a], &ranges[b]))
+      return true;
+
+   unsigned reg_a = ra_get_node_reg(g, a);
+   unsigned reg_b = ra_get_node_reg(g, b);
+
+   if (first_hw_reg(reg_a) <= last_hw_reg(reg_b) &&
+       first_hw_reg(reg_b) <= last_hw_reg(reg_a)) {
+      printf("nodes %u and %u got conflicting registers %u and %u\n",
+             a, b, reg_a, reg_b);
+      return false;
+   }
+
+   return true;
+}
+
+static bool
+run(const char *name, unsigned num_nodes, bool benchmark)
+{
+   void *mem_ctx = ralloc_context(NULL);
+   unsigned single_class, pair_class;
+   struct ra_regs *regs = create_reg_set(mem_ctx, &single_class, &pair_class);
+   /* Room for one fill temporary per spill. */
+   struct range *ranges = calloc(2 * num_nodes, sizeof(*ranges));
+   unsigned count = num_nodes;
+   unsigned spills = 0;
+   bool pass = true;
+
+   /* Starts are increasing, and the length is chosen so that about 50
+    * registers are live at any point.
+    */
+   for (unsigned i = 0; i < num_nodes; i++) {
+      ranges[i].start = i;
+      ranges[i].end = i + 1 + rand_next() % MAX_LEN;
+      ranges[i].pair = rand_next() % 4 == 0;
+   }
+
+   int64_t start = os_time_get_nano();
+
+   struct ra_graph *g = ra_alloc_interference_graph(regs, num_nodes);
+
+   for (unsigned i = 0; i < num_nodes; i++) {
+      ra_set_node_class(g, i, ranges[i].pair ? pair_class : single_class);
+      ra_set_node_spill_cost(g, i, 1.0f + rand_next() % 16);
+   }
+
+   /* Since the ranges are sorted by start, only the next MAX_LEN nodes can
+    * start before this one ends.
+    */
+   for (unsigned i = 0; i < num_nodes; i++)
+      add_interference(g, ranges, i, i + 1, MIN2(num_nodes, i + MAX_LEN));
+
+   while (!ra_allocate(g)) {
+      int n = ra_get_best_spill_node(g);
+      assert(n >= 0);
+
+      ranges[n].spilled = true;
+      ra_reset_node_interference(g, n);
+      ra_set_node_spill_cost(g, n, 0.0f);
+
+      /* The fill temporary is live for a single instruction. */
+      unsigned t = ra_add_node(g, ra_get_node_class(g, n));
+      assert(t == count);
+      ranges[t].start = ranges[n].start;
+      ranges[t].end = ranges[n].start + 1;
+      ranges[t].pair = ranges[n].pair;
+      count++;
+
+      unsigned first = ranges[t].start >= MAX_LEN ?
+                       ranges[t].start - MAX_LEN : 0;
+      add_interference(g, ranges, t, first, MIN2(num_nodes, ranges[t].end));
+      add_interference(g, ranges, t, num_nodes, t);
+
+      spills++;
+      assert(count < 2 * num_nodes);
+   }
+
+   int64_t elapsed = os_time_get_nano() - start;
+
+   /* Without spills, the graph would never grow past its initial size. */
+   assert(spills > 0);
+
+   /* Check that no two live ranges that overlap got conflicting
+    * registers.  Fill temporaries are checked against everything that may
+    * overlap them.
+    */
+   for (unsigned a = 0; a < count; a++) {
+      unsigned first = a < num_nodes ? a + 1 : 0;
+      unsigned last = a < num_nodes ? MIN2(num_nodes, a + MAX_LEN) : count;
+
+      for (unsigned b = first; b < last; b++)
+         pass &= check_pair(g, ranges, a, b);
+   }
+
+   if (benchmark) {
+      printf("%s: %u nodes, %u spills, %.1f ms\n", name, num_nodes, spills,
+             elapsed / 1000000.0);
+   } else {
+      printf("%s: %u nodes, %u spills\n", name, num_nodes, spills);
+   }
+
+   ralloc_free(g);
+   ralloc_free(mem_ctx);
+   free(ranges);
+
+   return pass;
+}
+
+int
+main(int argc, char **argv)
+{
+   bool pass = true;
+
+   if (argc > 1 && strcmp(argv[1], "--benchmark") == 0) {
+      pass &= run("small", 2000, true);
+      pass &= run("large", 10000, true);
+   } else {
+      pass &= run("dense to sparse", 4064, false);
+   }
+
+   return pass ? 0 : 1;
+}
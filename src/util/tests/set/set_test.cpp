@@ -146,3 +146,59 @@ TEST(set, search_or_add)
 
    _mesa_set_destroy(s, NULL);
 }
+
+TEST(set, group_probing)
+{
+   struct set *ref = _mesa_set_create(NULL, hash_int, cmp_int);
+   struct set *s = _mesa_set_create(NULL, hash_int, cmp_int);
+   static int keys[1000];
+   unsigned seed = 1;
+
+   ASSERT_TRUE(_mesa_set_enable_group_probing(s));
+
+   for (unsigned i = 0; i < ARRAY_SIZE(keys); i++)
+      keys[i] = i;
+
+   /* Mirror a random sequence of operations on a default set. */
+   for (unsigned i = 0; i < 100000; i++) {
+      seed = seed * 1103515245 + 12345;
+      int *key = &keys[(seed >> 8) % ARRAY_SIZE(keys)];
+
+      switch ((seed >> 24) % 3) {
+      case 0: {
+         bool found_ref, found;
+         _mesa_set_search_and_add(ref, key, &found_ref);
+         _mesa_set_search_and_add(s, key, &found);
+         EXPECT_EQ(found, found_ref);
+         break;
+      }
+      case 1:
+         _mesa_set_remove_key(ref, key);
+         _mesa_set_remove_key(s, key);
+         break;
+      default:
+         EXPECT_EQ(_mesa_set_search(s, key) != NULL,
+                   _mesa_set_search(ref, key) != NULL);
+         break;
+      }
+      ASSERT_EQ(s->entries, ref->entries);
+   }
+
+   _mesa_set_resize(s, 4000);
+   struct set *clone = _mesa_set_clone(s, NULL);
+   EXPECT_EQ(clone->entries, ref->entries);
+   set_foreach(ref, entry) {
+      EXPECT_TRUE(_mesa_set_search(s, entry->key));
+      EXPECT_TRUE(_mesa_set_search(clone, entry->key));
+   }
+
+   _mesa_set_clear(s, NULL);
+   EXPECT_EQ(s->entries, 0);
+   EXPECT_EQ(_mesa_set_next_entry(s, NULL), nullptr);
+   for (unsigned i = 0; i < ARRAY_SIZE(keys); i++)
+      EXPECT_FALSE(_mesa_set_search(s, &keys[i]));
+
+   _mesa_set_destroy(ref, NULL);
+   _mesa_set_destroy(s, NULL);
+   _mesa_set_destroy(clone, NULL);
+}
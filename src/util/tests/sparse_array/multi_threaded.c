@@ -68,6 +68,12 @@ run_test(unsigned run_idx)
 
    util_sparse_array_validate(&arr);
 
+   for (unsigned i = 0; i < MAX_ARR_SIZE; i++) {
+      uint32_t *elem = util_sparse_array_get_if_present(&arr, i);
+      assert(elem == NULL || *elem == 0 || *elem == i);
+   }
+   assert(util_sparse_array_get_if_present(&arr, 1ull << 40) == NULL);
+
    for (unsigned i = 0; i < MAX_ARR_SIZE; i++) {
       uint32_t *elem = util_sparse_array_get(&arr, i);
       assert(*elem == 0 || *elem == i);
@@ -641,6 +641,32 @@ util_queue_drop_job(struct util_queue *queue, struct util_queue_fence *fence)
       util_queue_fence_wait(fence);
 }
 
+void
+util_queue_promote_job(struct util_queue *queue, struct util_queue_fence *fence)
+{
+   if (util_queue_fence_is_signalled(fence))
+      return;
+
+   mtx_lock(&queue->lock);
+   for (unsigned i = queue->read_idx; i != queue->write_idx;
+        i = (i + 1) % queue->max_jobs) {
+      if (queue->jobs[i].fence == fence) {
+         struct util_queue_job job = queue->jobs[i];
+
+         /* Shift the jobs before it back by one slot to keep their order. */
+         while (i != queue->read_idx) {
+            unsigned prev = (i + queue->max_jobs - 1) % queue->max_jobs;
+
+            queue->jobs[i] = queue->jobs[prev];
+            i = prev;
+         }
+         queue->jobs[queue->read_idx] = job;
+         break;
+      }
+   }
+   mtx_unlock(&queue->lock);
+}
+
 static void
 util_queue_finish_execute(void *data, int num_thread)
 {
@@ -237,6 +237,14 @@ void util_queue_add_job(struct util_queue *queue,
 void util_queue_drop_job(struct util_queue *queue,
                          struct util_queue_fence *fence);
 
+/* Move a queued job to the front of the queue, so that it's the next one
+ * to be executed. Useful before waiting for a job that is needed now while
+ * other jobs are still pending. Does nothing if the job is already running
+ * or done.
+ */
+void util_queue_promote_job(struct util_queue *queue,
+                            struct util_queue_fence *fence);
+
 void util_queue_finish(struct util_queue *queue);
 
 /* Adjust the number of active threads. The new number of threads can't be
@@ -268,6 +276,8 @@ struct util_queue_monitoring
    unsigned num_offloaded_items;
    unsigned num_direct_items;
    unsigned num_syncs;
+   unsigned num_batches;
+   unsigned num_uploads;
 };
 
 #ifdef __cplusplus